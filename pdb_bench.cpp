@@ -0,0 +1,806 @@
+/*
+* pdb_bench - A benchmark for pdb_viewer extraction stages
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* It runs the extraction stages of pdb_viewer over a corpus, and reports
+* their throughput.
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <strings.h>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+#include "pdb_view.h"
+
+typedef enum
+{
+    stage_header = 0,
+    stage_root,
+    stage_fetch,
+    stage_decode,
+    stage_output = stage_decode + stream_kinds_count,
+    stages_count,
+} bench_stages_t;
+
+struct bench_stage_t
+{
+    bench_stage_t();
+
+    uint64_t bytes;
+    uint64_t records;
+    /* One sample per repetition, the stage time over the whole corpus */
+    std::vector<uint64_t> samples;
+};
+
+/* What is run with more threads */
+typedef enum
+{
+    scaling_none = 0,
+    scaling_batch,
+    scaling_stream,
+} bench_scaling_t;
+
+struct bench_options_t
+{
+    uint32_t warmup;
+    uint32_t repetitions;
+    char const * json_file;
+    bool backends[io_backends_count];
+    bool warm_cache;
+    bool cold_cache;
+    bench_scaling_t scaling;
+    std::vector<uint32_t> threads;
+};
+
+class pdb_bench_t
+{
+public:
+    pdb_bench_t(bench_options_t const & options, std::vector<std::string> const & files, io_backend_t backend, bool cold_cache);
+
+    int run();
+    void report();
+    void report_json(std::ostream & json);
+
+private:
+    typedef std::chrono::steady_clock clock_t;
+
+    void run_file(std::string const & path, bool measure);
+    void record(uint32_t stage, clock_t::time_point start, uint64_t bytes, uint64_t records, bool measure);
+
+    static uint64_t percentile(std::vector<uint64_t> samples, uint32_t percent);
+    static std::string stage_name(uint32_t stage);
+
+    bench_options_t const & _options;
+    pdb_options_t _pdb_options;
+    std::vector<std::string> const & _files;
+    bool _cold_cache;
+    bench_stage_t _stages[stages_count];
+    uint64_t _pending[stages_count];
+};
+
+/* Runs the whole extraction of the corpus with growing thread counts, each
+ * run in its own process so that its peak RSS can be measured */
+class pdb_scaling_t
+{
+public:
+    pdb_scaling_t(bench_options_t const & options, std::vector<std::string> const & files, io_backend_t backend, bool cold_cache);
+
+    int run();
+    void report();
+    void report_json(std::ostream & json);
+
+private:
+    int run_child(uint32_t threads, uint64_t * elapsed, uint64_t * peak_rss);
+
+    bench_options_t const & _options;
+    std::vector<std::string> const & _files;
+    io_backend_t _backend;
+    bool _cold_cache;
+    /* Per thread count */
+    std::vector<std::vector<uint64_t> > _samples;
+    std::vector<uint64_t> _peak_rss;
+};
+
+bench_stage_t::bench_stage_t()
+{
+    bytes = 0;
+    records = 0;
+}
+
+pdb_bench_t::pdb_bench_t(bench_options_t const & options, std::vector<std::string> const & files, io_backend_t backend, bool cold_cache) : _options(options), _files(files)
+{
+    _pdb_options.io_backend = backend;
+    _cold_cache = cold_cache;
+}
+
+static int add_corpus(char const * const path, std::vector<std::string> & files)
+{
+    struct stat buf;
+    DIR * dir;
+    struct dirent * entry;
+
+    if (stat(path, &buf) == -1)
+    {
+        std::cerr << "Cannot access '" << path << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    if (!S_ISDIR(buf.st_mode))
+    {
+        files.push_back(path);
+        return 0;
+    }
+
+    dir = opendir(path);
+    if (dir == 0)
+    {
+        std::cerr << "Cannot open directory '" << path << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    /* Only the PDB files of the directory */
+    while ((entry = readdir(dir)) != 0)
+    {
+        size_t length = strlen(entry->d_name);
+
+        if (length > 4 && strcasecmp(entry->d_name + length - 4, ".pdb") == 0)
+        {
+            files.push_back(std::string(path) + "/" + entry->d_name);
+        }
+    }
+
+    closedir(dir);
+    return 0;
+}
+
+void pdb_bench_t::record(uint32_t stage, clock_t::time_point start, uint64_t bytes, uint64_t records, bool measure)
+{
+    if (!measure)
+    {
+        return;
+    }
+
+    _pending[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+    _stages[stage].bytes += bytes;
+    _stages[stage].records += records;
+}
+
+static void evict(std::string const & path)
+{
+    int fd;
+
+    /* Best effort: only clean pages not mapped elsewhere are dropped */
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+void pdb_bench_t::run_file(std::string const & path, bool measure)
+{
+    pdb_file_t pdb_file(path.c_str(), _pdb_options);
+    clock_t::time_point start;
+    uint16_t entry;
+    int ret;
+
+    if (_cold_cache)
+    {
+        evict(path);
+    }
+
+    /* Same steps as extract_pdb(), each one timed */
+    if (pdb_file.open_file() == -1)
+    {
+        return;
+    }
+
+    start = clock_t::now();
+    ret = pdb_file.validate_header();
+    record(stage_header, start, PDB_SIGNATURE_200_SIZE + sizeof(pdb_header_t), 1, measure);
+    if (ret == -1)
+    {
+        return;
+    }
+
+    start = clock_t::now();
+    ret = pdb_file.open_root_stream();
+    record(stage_root, start, pdb_file.root_stream_size(), pdb_file.streams_count(), measure);
+    if (ret == -1)
+    {
+        return;
+    }
+
+    for (entry = 0; entry < pdb_file.streams_count(); ++entry)
+    {
+        void * stream_buffer;
+        stream_kind_t kind;
+        uint32_t size;
+
+        /* Empty and free streams have nothing to fetch */
+        size = pdb_file.stream_size(entry);
+        if (size == 0)
+        {
+            continue;
+        }
+
+        start = clock_t::now();
+        stream_buffer = pdb_file.fetch_stream(entry);
+        record(stage_fetch, start, stream_buffer != 0 ? size : 0, stream_buffer != 0 ? 1 : 0, measure);
+        if (stream_buffer == 0)
+        {
+            continue;
+        }
+
+        kind = pdb_file.stream_kind(entry);
+        start = clock_t::now();
+        pdb_file.decode_stream(entry, stream_buffer);
+        record((uint32_t)stage_decode + kind, start, size, kind == stream_kind_sym ? pdb_file.symbols_count() : 1, measure);
+
+        if (kind == stream_kind_sym)
+        {
+            start = clock_t::now();
+            pdb_file.print_symbols();
+            fflush(stdout);
+            record(stage_output, start, 0, pdb_file.symbols_count(), measure);
+        }
+    }
+}
+
+int pdb_bench_t::run()
+{
+    uint32_t repetition;
+    uint32_t stage;
+
+    for (repetition = 0; repetition < _options.warmup + _options.repetitions; ++repetition)
+    {
+        bool measure = (repetition >= _options.warmup);
+
+        memset(_pending, 0, sizeof(_pending));
+        for (std::vector<std::string>::const_iterator it = _files.begin(); it != _files.end(); ++it)
+        {
+            run_file(*it, measure);
+        }
+
+        if (!measure)
+        {
+            continue;
+        }
+
+        for (stage = 0; stage < stages_count; ++stage)
+        {
+            _stages[stage].samples.push_back(_pending[stage]);
+        }
+    }
+
+    return 0;
+}
+
+uint64_t pdb_bench_t::percentile(std::vector<uint64_t> samples, uint32_t percent)
+{
+    size_t rank;
+
+    std::sort(samples.begin(), samples.end());
+
+    /* Nearest rank */
+    rank = (samples.size() * percent + 99) / 100;
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    return samples[rank - 1];
+}
+
+std::string pdb_bench_t::stage_name(uint32_t stage)
+{
+    switch (stage)
+    {
+        case stage_header:
+            return "header";
+
+        case stage_root:
+            return "root";
+
+        case stage_fetch:
+            return "fetch";
+
+        case stage_output:
+            return "output";
+
+        default:
+            return std::string("decode_") + stream_kind_names[stage - stage_decode];
+    }
+}
+
+void pdb_bench_t::report()
+{
+    uint32_t stage;
+
+    fprintf(stderr, "%u files, %s I/O, %s cache, %u warmup runs, %u measured runs\n", (uint32_t)_files.size(), io_backend_names[_pdb_options.io_backend],
+            _cold_cache ? "cold" : "warm", _options.warmup, _options.repetitions);
+    fprintf(stderr, "%-18s %12s %14s %12s %12s %12s %12s\n", "stage", "MB/s", "records/s", "ns/record", "p50 ms", "p90 ms", "p99 ms");
+
+    for (stage = 0; stage < stages_count; ++stage)
+    {
+        bench_stage_t const & current = _stages[stage];
+        double median = percentile(current.samples, 50);
+        double runs = current.samples.size();
+
+        if (current.records == 0)
+        {
+            continue;
+        }
+
+        /* Throughputs are taken from the median run */
+        fprintf(stderr, "%-18s %12.1f %14.0f %12.1f %12.3f %12.3f %12.3f\n", stage_name(stage).c_str(),
+                median != 0 ? (current.bytes / runs) / (median / 1e9) / (1024 * 1024) : 0.0,
+                median != 0 ? (current.records / runs) / (median / 1e9) : 0.0,
+                median / (current.records / runs),
+                median / 1e6, percentile(current.samples, 90) / 1e6, percentile(current.samples, 99) / 1e6);
+    }
+}
+
+void pdb_bench_t::report_json(std::ostream & json)
+{
+    uint32_t stage;
+    bool first = true;
+
+    json << "{\"io\":\"" << io_backend_names[_pdb_options.io_backend] << "\",\"cache\":\"" << (_cold_cache ? "cold" : "warm")
+         << "\",\"files\":" << _files.size() << ",\"warmup\":" << _options.warmup << ",\"repetitions\":" << _options.repetitions << ",\"stages\":[";
+    for (stage = 0; stage < stages_count; ++stage)
+    {
+        bench_stage_t const & current = _stages[stage];
+        double runs = current.samples.size();
+
+        if (current.records == 0)
+        {
+            continue;
+        }
+
+        json << (first ? "" : ",") << "{\"name\":\"" << stage_name(stage) << "\",\"bytes_per_run\":" << (uint64_t)(current.bytes / runs)
+             << ",\"records_per_run\":" << (uint64_t)(current.records / runs) << ",\"samples_ns\":[";
+        for (std::vector<uint64_t>::const_iterator it = current.samples.begin(); it != current.samples.end(); ++it)
+        {
+            json << (it == current.samples.begin() ? "" : ",") << *it;
+        }
+        json << "],\"min_ns\":" << percentile(current.samples, 0) << ",\"p50_ns\":" << percentile(current.samples, 50)
+             << ",\"p90_ns\":" << percentile(current.samples, 90) << ",\"p99_ns\":" << percentile(current.samples, 99)
+             << ",\"max_ns\":" << percentile(current.samples, 100) << "}";
+        first = false;
+    }
+    json << "]}";
+}
+
+pdb_scaling_t::pdb_scaling_t(bench_options_t const & options, std::vector<std::string> const & files, io_backend_t backend, bool cold_cache) : _options(options), _files(files)
+{
+    _backend = backend;
+    _cold_cache = cold_cache;
+    _samples.resize(options.threads.size());
+    _peak_rss.resize(options.threads.size(), 0);
+}
+
+int pdb_scaling_t::run_child(uint32_t threads, uint64_t * elapsed, uint64_t * peak_rss)
+{
+    typedef std::chrono::steady_clock clock_t;
+    clock_t::time_point start;
+    struct rusage usage;
+    int status;
+    pid_t child;
+
+    if (_cold_cache)
+    {
+        for (std::vector<std::string>::const_iterator it = _files.begin(); it != _files.end(); ++it)
+        {
+            evict(*it);
+        }
+    }
+
+    start = clock_t::now();
+    child = fork();
+    if (child == -1)
+    {
+        std::cerr << "Failed to fork. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    if (child == 0)
+    {
+        std::vector<char const *> files;
+        pdb_options_t options;
+
+        for (std::vector<std::string>::const_iterator it = _files.begin(); it != _files.end(); ++it)
+        {
+            files.push_back(it->c_str());
+        }
+
+        options.io_backend = _backend;
+        if (_options.scaling == scaling_batch)
+        {
+            options.jobs = threads;
+        }
+        else
+        {
+            options.stream_jobs = threads;
+        }
+
+        extract_files(files, options);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    if (wait4(child, &status, 0, &usage) == -1)
+    {
+        std::cerr << "Failed to wait for child. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    *elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "Extraction with " << threads << " threads failed" << std::endl;
+        return -1;
+    }
+
+    /* In KB on Linux */
+    *peak_rss = (uint64_t)usage.ru_maxrss * 1024;
+    return 0;
+}
+
+int pdb_scaling_t::run()
+{
+    uint32_t config;
+    uint32_t repetition;
+
+    for (config = 0; config < _options.threads.size(); ++config)
+    {
+        for (repetition = 0; repetition < _options.warmup + _options.repetitions; ++repetition)
+        {
+            uint64_t elapsed;
+            uint64_t peak_rss;
+
+            if (run_child(_options.threads[config], &elapsed, &peak_rss) == -1)
+            {
+                return -1;
+            }
+
+            if (repetition < _options.warmup)
+            {
+                continue;
+            }
+
+            _samples[config].push_back(elapsed);
+            _peak_rss[config] = std::max(_peak_rss[config], peak_rss);
+        }
+
+        std::sort(_samples[config].begin(), _samples[config].end());
+    }
+
+    return 0;
+}
+
+void pdb_scaling_t::report()
+{
+    uint32_t config;
+    double base;
+
+    fprintf(stderr, "%u files, %s scaling, %s I/O, %s cache, %u warmup runs, %u measured runs\n", (uint32_t)_files.size(),
+            _options.scaling == scaling_batch ? "batch" : "stream", io_backend_names[_backend], _cold_cache ? "cold" : "warm",
+            _options.warmup, _options.repetitions);
+    fprintf(stderr, "%8s %12s %12s %12s %10s %12s\n", "threads", "p50 ms", "min ms", "speedup", "efficiency", "peak RSS MB");
+
+    /* Relative to the first thread count */
+    base = _samples[0][_samples[0].size() / 2];
+    for (config = 0; config < _options.threads.size(); ++config)
+    {
+        double median = _samples[config][_samples[config].size() / 2];
+        double speedup = base / median;
+
+        fprintf(stderr, "%8u %12.3f %12.3f %12.2f %9.0f%% %12.1f\n", _options.threads[config], median / 1e6, _samples[config][0] / 1e6,
+                speedup, 100 * speedup * _options.threads[0] / _options.threads[config], _peak_rss[config] / (1024.0 * 1024.0));
+    }
+}
+
+void pdb_scaling_t::report_json(std::ostream & json)
+{
+    uint32_t config;
+
+    json << "{\"scaling\":\"" << (_options.scaling == scaling_batch ? "batch" : "stream") << "\",\"io\":\"" << io_backend_names[_backend]
+         << "\",\"cache\":\"" << (_cold_cache ? "cold" : "warm") << "\",\"files\":" << _files.size() << ",\"warmup\":" << _options.warmup
+         << ",\"repetitions\":" << _options.repetitions << ",\"threads\":[";
+    for (config = 0; config < _options.threads.size(); ++config)
+    {
+        json << (config == 0 ? "" : ",") << "{\"threads\":" << _options.threads[config] << ",\"samples_ns\":[";
+        for (std::vector<uint64_t>::const_iterator it = _samples[config].begin(); it != _samples[config].end(); ++it)
+        {
+            json << (it == _samples[config].begin() ? "" : ",") << *it;
+        }
+        json << "],\"p50_ns\":" << _samples[config][_samples[config].size() / 2] << ",\"peak_rss\":" << _peak_rss[config] << "}";
+    }
+    json << "]}";
+}
+
+static void usage(char const * const program)
+{
+    std::cerr << "Usage: " << program << " [options] file.pdb|directory [...]\n"
+                 "  --warmup=COUNT       runs over the corpus before measuring (default: 1)\n"
+                 "  --repetitions=COUNT  measured runs over the corpus (default: 5)\n"
+                 "  --io=LIST            comma separated I/O backends to run: stdio, pread, mmap or all (default: stdio)\n"
+                 "  --cache=MODE         warm, cold (file evicted from the page cache before each run) or both (default: warm)\n"
+                 "  --scaling=MODE       instead of stages, time the whole extraction with growing thread counts,\n"
+                 "                       over several files (batch) or over the streams of each file (stream)\n"
+                 "  --threads=LIST       comma separated thread counts for --scaling (default: 1,2,4,8)\n"
+                 "  --json=FILE          also write the results as JSON to FILE" << std::endl;
+}
+
+static int parse_backends(char const * const list, bool * backends)
+{
+    std::string backend;
+    char const * name = list;
+    uint32_t index;
+
+    for (;;)
+    {
+        char const * end = strchr(name, ',');
+
+        backend.assign(name, end == 0 ? strlen(name) : end - name);
+        for (index = 0; index < io_backends_count; ++index)
+        {
+            if (backend == "all" || backend == io_backend_names[index])
+            {
+                backends[index] = true;
+                if (backend != "all")
+                {
+                    break;
+                }
+            }
+        }
+
+        if (index == io_backends_count && backend != "all")
+        {
+            std::cerr << "Unknown I/O backend: " << backend << std::endl;
+            return -1;
+        }
+
+        if (end == 0)
+        {
+            return 0;
+        }
+
+        name = end + 1;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int idx;
+    bench_options_t options;
+    std::vector<std::string> files;
+    std::ofstream json;
+    bool first = true;
+    bool backends = false;
+    uint32_t backend;
+    uint32_t cold;
+
+    options.warmup = 1;
+    options.repetitions = 5;
+    options.json_file = 0;
+    memset(options.backends, 0, sizeof(options.backends));
+    options.warm_cache = true;
+    options.cold_cache = false;
+    options.scaling = scaling_none;
+
+    for (idx = 1; idx < argc; ++idx)
+    {
+        if (sscanf(argv[idx], "--warmup=%u", &options.warmup) == 1)
+        {
+        }
+        else if (sscanf(argv[idx], "--repetitions=%u", &options.repetitions) == 1)
+        {
+            if (options.repetitions == 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strncmp(argv[idx], "--json=", 7) == 0)
+        {
+            options.json_file = argv[idx] + 7;
+        }
+        else if (strncmp(argv[idx], "--io=", 5) == 0)
+        {
+            if (parse_backends(argv[idx] + 5, options.backends) == -1)
+            {
+                return 1;
+            }
+
+            backends = true;
+        }
+        else if (strcmp(argv[idx], "--scaling=batch") == 0)
+        {
+            options.scaling = scaling_batch;
+        }
+        else if (strcmp(argv[idx], "--scaling=stream") == 0)
+        {
+            options.scaling = scaling_stream;
+        }
+        else if (strncmp(argv[idx], "--threads=", 10) == 0)
+        {
+            char const * count = argv[idx] + 10;
+            char * end;
+
+            options.threads.clear();
+            for (;;)
+            {
+                unsigned long threads = strtoul(count, &end, 10);
+
+                if (end == count || threads == 0 || (*end != ',' && *end != 0))
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                options.threads.push_back(threads);
+                if (*end == 0)
+                {
+                    break;
+                }
+
+                count = end + 1;
+            }
+        }
+        else if (strncmp(argv[idx], "--cache=", 8) == 0)
+        {
+            options.warm_cache = (strcmp(argv[idx] + 8, "warm") == 0 || strcmp(argv[idx] + 8, "both") == 0);
+            options.cold_cache = (strcmp(argv[idx] + 8, "cold") == 0 || strcmp(argv[idx] + 8, "both") == 0);
+            if (!options.warm_cache && !options.cold_cache)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strncmp(argv[idx], "--", 2) == 0)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else if (add_corpus(argv[idx], files) == -1)
+        {
+            return 1;
+        }
+    }
+
+    if (files.empty())
+    {
+        std::cerr << "No PDB file to benchmark" << std::endl;
+        return 1;
+    }
+
+    if (!backends)
+    {
+        /* Streams can only be fetched concurrently with pread() or a mapping */
+        options.backends[options.scaling == scaling_stream ? io_backend_pread : io_backend_stdio] = true;
+    }
+
+    if (options.scaling == scaling_stream && options.backends[io_backend_stdio])
+    {
+        std::cerr << "Streams aren't fetched concurrently with stdio, skipping it" << std::endl;
+        options.backends[io_backend_stdio] = false;
+    }
+
+    if (options.threads.empty())
+    {
+        options.threads.push_back(1);
+        options.threads.push_back(2);
+        options.threads.push_back(4);
+        options.threads.push_back(8);
+    }
+
+    if (options.json_file != 0)
+    {
+        json.open(options.json_file);
+        if (!json)
+        {
+            std::cerr << "Cannot open file '" << options.json_file << "'" << std::endl;
+            return 1;
+        }
+
+        json << "{\"configurations\":[";
+    }
+
+    /* The decoders print as they go, that's not what is measured */
+    if (freopen("/dev/null", "w", stdout) == 0)
+    {
+        std::cerr << "Failed to discard standard output. Error: " << errno << std::endl;
+        return 1;
+    }
+
+    for (backend = 0; backend < io_backends_count; ++backend)
+    {
+        if (!options.backends[backend])
+        {
+            continue;
+        }
+
+        for (cold = 0; cold < 2; ++cold)
+        {
+            if ((cold && !options.cold_cache) || (!cold && !options.warm_cache))
+            {
+                continue;
+            }
+
+            if (options.scaling != scaling_none)
+            {
+                pdb_scaling_t scaling(options, files, (io_backend_t)backend, cold != 0);
+
+                if (scaling.run() == -1)
+                {
+                    return 1;
+                }
+
+                scaling.report();
+                if (options.json_file != 0)
+                {
+                    json << (first ? "" : ",");
+                    scaling.report_json(json);
+                }
+            }
+            else
+            {
+                pdb_bench_t bench(options, files, (io_backend_t)backend, cold != 0);
+
+                if (bench.run() == -1)
+                {
+                    return 1;
+                }
+
+                bench.report();
+                if (options.json_file != 0)
+                {
+                    json << (first ? "" : ",");
+                    bench.report_json(json);
+                }
+            }
+
+            first = false;
+        }
+    }
+
+    if (options.json_file != 0)
+    {
+        json << "]}" << std::endl;
+        if (!json)
+        {
+            std::cerr << "Failed to write '" << options.json_file << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,794 @@
+/*
+* pdb_generator - A tool for generating synthetic PDB files
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* It writes PDB 2.00 files laid out the way pdb_viewer reads them, to build
+* reproducible benchmark corpora.
+*/
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include "pdb_synth.h"
+
+#define PDB_SIGNATURE_200 "Microsoft C/C++ program database 2.00\r\n\x1AJG\0"
+#define PDB_SIGNATURE_200_SIZE sizeof(PDB_SIGNATURE_200)
+
+/* Page numbers are 16-bit in PDB 2.00 */
+#define PDB_MAX_PAGES 0xFFFF
+
+struct __attribute__((__packed__)) pdb_stream_t
+{
+    uint32_t stream_size;
+    uint16_t stream_page[2];
+};
+
+struct __attribute__((__packed__)) pdb_header_t
+{
+    uint32_t page_size;
+    uint16_t start_page;
+    uint16_t file_pages;
+    pdb_stream_t root_stream;
+};
+
+struct __attribute__((__packed__)) pdb_stream_header_t
+{
+    uint32_t version;
+    uint32_t signature;
+    uint32_t age;
+};
+
+struct __attribute__((__packed__)) tpi_header_t
+{
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t min_ti;
+    uint32_t max_ti;
+    uint32_t size;
+};
+
+struct __attribute__((__packed__)) dbi_header_t
+{
+    uint32_t signature;
+    uint32_t version;
+    uint32_t age;
+    uint16_t global_symbols_stream;
+    uint16_t dll_version;
+    uint16_t private_symbols_stream;
+    uint16_t dll_build_number;
+    uint16_t symbols_stream;
+    uint16_t dll_rebuild_number;
+    uint32_t module_info_size;
+    uint32_t section_contribution_size;
+    uint32_t section_map_size;
+    uint32_t file_info_size;
+    uint32_t type_server_map_size;
+    uint32_t mfc_type_server_index;
+    uint32_t debug_header_size;
+    uint32_t ec_info_size;
+    uint16_t flags;
+    uint16_t machine;
+    uint32_t reserved;
+};
+
+struct __attribute__((__packed__)) section_contribution_t
+{
+    uint16_t section;
+    uint16_t padding1;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t characteristics;
+    uint16_t module_index;
+    uint16_t padding2;
+    uint32_t data_crc;
+    uint32_t reloc_crc;
+};
+
+struct __attribute__((__packed__)) module_info_t
+{
+    uint32_t reserved1;
+    section_contribution_t section_contribution;
+    uint16_t flags;
+    uint16_t symbols_stream;
+    uint32_t symbols_size;
+    uint32_t c11_lines_size;
+    uint32_t c13_lines_size;
+    uint16_t source_files;
+    uint16_t padding;
+    uint32_t reserved2;
+    uint32_t source_file_name;
+    uint32_t pdb_file_path_name;
+};
+
+typedef enum
+{
+    type_root_t = 0,
+    type_pdb_header_t,
+    type_tpi,
+    type_dbi,
+    type_fpo = 5,
+    type_gs,
+    type_ps,
+    type_sym,
+    type_filler,
+} generated_streams_t;
+
+struct generator_options_t
+{
+    uint32_t page_size;
+    uint32_t symbols;
+    uint32_t min_name_length;
+    uint32_t max_name_length;
+    uint32_t padding;
+    uint32_t modules;
+    uint32_t templates;
+    uint32_t types;
+    uint32_t renumber;
+    uint32_t filler_streams;
+    uint64_t file_size;
+    uint32_t fragmentation;
+    uint32_t seed;
+};
+
+class pdb_generator_t
+{
+public:
+    pdb_generator_t(char const * const pdb_file, generator_options_t const & options);
+    ~pdb_generator_t();
+
+    int generate();
+
+private:
+    void build_symbols();
+    void build_modules(dbi_header_t * dbi_header);
+    void build_types(tpi_header_t * tpi_header);
+    int layout();
+    int write_stream(uint16_t stream_index, std::string const & data, std::vector<uint16_t> const & stream_pages);
+    int write_filler(uint16_t stream_index);
+
+    uint32_t pages(uint32_t size) const { return size / _options.page_size + 1; }
+
+    static uint32_t const segments_count = 4;
+
+    std::string _pdb_file;
+    generator_options_t const & _options;
+    std::mt19937 _random;
+    FILE * _pdb_stream;
+    std::vector<std::string> _streams;
+    std::vector<uint32_t> _sizes;
+    std::vector<std::vector<uint16_t> > _pages;
+    std::vector<uint16_t> _root_pages;
+    uint32_t _file_pages;
+    /* Where the symbols of each segment end, indexed from 1 */
+    uint32_t _segment_ends[segments_count + 1];
+};
+
+pdb_generator_t::pdb_generator_t(char const * const pdb_file, generator_options_t const & options) : _options(options), _random(options.seed)
+{
+    _pdb_file = pdb_file;
+    _pdb_stream = 0;
+    _file_pages = 0;
+}
+
+pdb_generator_t::~pdb_generator_t()
+{
+    if (_pdb_stream != 0)
+    {
+        fclose(_pdb_stream);
+        _pdb_stream = 0;
+    }
+}
+
+void pdb_generator_t::build_symbols()
+{
+    synth_symbols_t params;
+
+    params.symbols = _options.symbols;
+    params.min_name_length = _options.min_name_length;
+    params.max_name_length = _options.max_name_length;
+    params.padding = _options.padding;
+    params.unique_names = 0;
+    params.templates = _options.templates;
+
+    synth_symbol_stream(_streams[type_sym], _random, params, _segment_ends);
+}
+
+/* Module info records, each with its contribution to the code section.
+ * The section contributions substream has one per module to each of the
+ * symbols segments, whose ranges are split among the modules, so that all
+ * symbols are in one */
+void pdb_generator_t::build_modules(dbi_header_t * dbi_header)
+{
+    static uint32_t const characteristics[segments_count + 1] = { 0, 0x60000020, 0xC0000040, 0x40000040, 0xC0000080 };
+    std::uniform_int_distribution<uint32_t> weight(0x10, 0x400);
+    std::string & stream = _streams[type_dbi];
+    std::vector<section_contribution_t> contributions;
+    std::vector<uint64_t> weights(_options.modules);
+    uint64_t total;
+    uint64_t sum;
+    uint32_t segment;
+    uint32_t module;
+
+    for (segment = 1; segment <= segments_count && _options.modules != 0; ++segment)
+    {
+        uint32_t offset = 0x1000;
+
+        total = 0;
+        for (module = 0; module < _options.modules; ++module)
+        {
+            weights[module] = weight(_random);
+            total += weights[module];
+        }
+
+        sum = 0;
+        for (module = 0; module < _options.modules; ++module)
+        {
+            section_contribution_t contribution;
+            uint32_t end;
+
+            sum += weights[module];
+            end = (module + 1 == _options.modules ? _segment_ends[segment] : (0x1000 + (_segment_ends[segment] - 0x1000) * sum / total) & ~0xF);
+
+            memset(&contribution, 0, sizeof(contribution));
+            contribution.section = segment;
+            contribution.offset = offset;
+            contribution.size = end - offset;
+            contribution.characteristics = characteristics[segment];
+            contribution.module_index = module;
+            contributions.push_back(contribution);
+            offset = end;
+        }
+    }
+
+    for (module = 0; module < _options.modules; ++module)
+    {
+        module_info_t info;
+        char name[32];
+
+        memset(&info, 0, sizeof(info));
+        info.section_contribution = contributions[module];
+        info.symbols_stream = 0xFFFF;
+
+        stream.append((char const *)&info, sizeof(info));
+        snprintf(name, sizeof(name), "module%u.obj", module);
+        stream.append(name, strlen(name) + 1);
+        snprintf(name, sizeof(name), "lib%u.lib", module % 8);
+        stream.append(name, strlen(name) + 1);
+        /* Records are aligned on 32-bit */
+        stream.append((4 - (stream.size() - sizeof(dbi_header_t)) % 4) % 4, '\0');
+    }
+
+    dbi_header->module_info_size = stream.size() - sizeof(dbi_header_t);
+
+    if (_options.modules != 0)
+    {
+        /* Version 6.0 entries */
+        synth_append<uint32_t>(stream, 0xEFFE0000 + 19970605);
+        stream.append((char const *)contributions.data(), contributions.size() * sizeof(section_contribution_t));
+        dbi_header->section_contribution_size = sizeof(uint32_t) + contributions.size() * sizeof(section_contribution_t);
+    }
+
+    memcpy(&stream[0], dbi_header, sizeof(dbi_header_t));
+}
+
+/* Structures of a universe shared by all files, see synth_type_stream() */
+void pdb_generator_t::build_types(tpi_header_t * tpi_header)
+{
+    std::string & stream = _streams[type_tpi];
+    std::vector<uint32_t> pointers;
+    uint32_t symbol = 0;
+    uint32_t offset;
+    char * symbols;
+
+    if (_options.types == 0)
+    {
+        return;
+    }
+
+    tpi_header->max_ti += synth_type_stream(stream, _random, _options.types, _options.renumber, &pointers);
+    tpi_header->size = stream.size() - sizeof(tpi_header_t);
+    memcpy(&stream[0], tpi_header, sizeof(tpi_header_t));
+
+    /* Symbols point to the structures, in the order they were drawn, so that
+     * renumbered files only differ by their type indexes */
+    symbols = &_streams[type_sym][0];
+    for (offset = sizeof(uint16_t); offset < _streams[type_sym].size(); )
+    {
+        if (*(uint16_t const *)(symbols + offset) == 0)
+        {
+            offset += sizeof(uint16_t);
+            continue;
+        }
+
+        memcpy(symbols + offset + sizeof(uint16_t), &pointers[symbol++ % pointers.size()], sizeof(uint32_t));
+        offset += 3 * sizeof(uint32_t) + 1 + (uint8_t)symbols[offset + 3 * sizeof(uint32_t)];
+        offset += (offset & 1);
+    }
+}
+
+int pdb_generator_t::layout()
+{
+    std::vector<uint16_t> free_pages;
+    uint64_t used_pages;
+    uint64_t filler_pages = 0;
+    uint32_t root_size;
+    uint32_t stream;
+    uint32_t page;
+    uint32_t next;
+
+    _sizes.resize(_streams.size());
+    for (stream = 0; stream < _streams.size(); ++stream)
+    {
+        _sizes[stream] = _streams[stream].size();
+    }
+
+    /* Page 0 holds the header, page 1 is reserved for the free page map */
+    used_pages = 2;
+    for (stream = type_pdb_header_t; stream < type_filler; ++stream)
+    {
+        if (_sizes[stream] != 0)
+        {
+            used_pages += pages(_sizes[stream]);
+        }
+    }
+
+    /* Spread what is left up to the requested file size over the filler streams */
+    if (_options.filler_streams != 0 && _options.file_size / _options.page_size > used_pages)
+    {
+        filler_pages = _options.file_size / _options.page_size - used_pages;
+    }
+
+    for (stream = 0; stream < _options.filler_streams; ++stream)
+    {
+        uint64_t stream_pages = filler_pages / _options.filler_streams;
+
+        if (stream_pages > PDB_MAX_PAGES)
+        {
+            stream_pages = PDB_MAX_PAGES;
+        }
+
+        _sizes[type_filler + stream] = (stream_pages == 0 ? 0 : (stream_pages - 1) * _options.page_size + 1);
+        if (_sizes[type_filler + stream] != 0)
+        {
+            used_pages += pages(_sizes[type_filler + stream]);
+        }
+    }
+
+    /* Streams sizes can't be an exact multiple of the page size, the reader always reads one page more */
+    for (stream = type_pdb_header_t; stream < type_filler; ++stream)
+    {
+        if (_sizes[stream] != 0 && _sizes[stream] % _options.page_size == 0)
+        {
+            ++_sizes[stream];
+            _streams[stream] += '\0';
+        }
+    }
+
+    /* The root stream lists its own pages (as stream 0), iterate until its size settles */
+    root_size = 0;
+    for (;;)
+    {
+        uint32_t size = 2 * sizeof(uint16_t) + _sizes.size() * sizeof(pdb_stream_t) + (used_pages - 2 + pages(root_size)) * sizeof(uint16_t);
+
+        if (size % _options.page_size == 0)
+        {
+            ++size;
+        }
+
+        if (size == root_size)
+        {
+            break;
+        }
+
+        root_size = size;
+    }
+
+    _sizes[type_root_t] = root_size;
+    _file_pages = used_pages + 2 * pages(root_size);
+    if (_file_pages > PDB_MAX_PAGES)
+    {
+        std::cerr << "Too many pages for '" << _pdb_file << "': " << _file_pages << ", PDB 2.00 is limited to " << PDB_MAX_PAGES << std::endl;
+        return -1;
+    }
+
+    if (PDB_SIGNATURE_200_SIZE + sizeof(pdb_header_t) + pages(root_size) * sizeof(uint16_t) > _options.page_size)
+    {
+        std::cerr << "Root stream pages list doesn't fit in the first page of '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    /* Fragment the file by swapping pages around */
+    for (page = 2; page < _file_pages; ++page)
+    {
+        free_pages.push_back(page);
+    }
+
+    if (_options.fragmentation != 0)
+    {
+        std::uniform_int_distribution<uint32_t> position(0, free_pages.size() - 1);
+        uint64_t swaps = (uint64_t)free_pages.size() * _options.fragmentation / 100;
+
+        while (swaps-- != 0)
+        {
+            std::swap(free_pages[position(_random)], free_pages[position(_random)]);
+        }
+    }
+
+    next = 0;
+    _pages.resize(_sizes.size());
+    for (stream = 0; stream < _sizes.size(); ++stream)
+    {
+        if (_sizes[stream] == 0)
+        {
+            continue;
+        }
+
+        for (page = 0; page < pages(_sizes[stream]); ++page)
+        {
+            _pages[stream].push_back(free_pages[next++]);
+        }
+    }
+
+    for (page = 0; page < pages(root_size); ++page)
+    {
+        _root_pages.push_back(free_pages[next++]);
+    }
+
+    /* Stream 0 is the previous root stream, a copy of the current one here */
+    _streams[type_root_t].assign(2 * sizeof(uint16_t), 0);
+    *(uint16_t *)&_streams[type_root_t][0] = _sizes.size();
+    for (stream = 0; stream < _sizes.size(); ++stream)
+    {
+        pdb_stream_t entry;
+
+        entry.stream_size = _sizes[stream];
+        entry.stream_page[0] = 0;
+        entry.stream_page[1] = 0;
+        _streams[type_root_t].append((char const *)&entry, sizeof(entry));
+    }
+
+    for (stream = 0; stream < _sizes.size(); ++stream)
+    {
+        _streams[type_root_t].append((char const *)_pages[stream].data(), _pages[stream].size() * sizeof(uint16_t));
+    }
+
+    _streams[type_root_t].resize(root_size, '\0');
+
+    return 0;
+}
+
+int pdb_generator_t::write_stream(uint16_t stream_index, std::string const & data, std::vector<uint16_t> const & stream_pages)
+{
+    uint32_t page;
+
+    for (page = 0; page < stream_pages.size(); ++page)
+    {
+        uint32_t to_write = std::min<uint32_t>(_options.page_size, data.size() - page * _options.page_size);
+
+        if (fseek(_pdb_stream, (long)stream_pages[page] * _options.page_size, SEEK_SET) == -1 ||
+            fwrite(data.data() + page * _options.page_size, to_write, 1, _pdb_stream) != 1)
+        {
+            std::cerr << "Failed to write page " << page << " of stream " << stream_index << " in '" << _pdb_file << "'. Error: " << errno << std::endl;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int pdb_generator_t::write_filler(uint16_t stream_index)
+{
+    std::vector<char> data(_options.page_size);
+    uint32_t page;
+
+    for (page = 0; page < _pages[stream_index].size(); ++page)
+    {
+        std::generate(data.begin(), data.end(), std::ref(_random));
+
+        if (fseek(_pdb_stream, (long)_pages[stream_index][page] * _options.page_size, SEEK_SET) == -1 ||
+            fwrite(&data[0], data.size(), 1, _pdb_stream) != 1)
+        {
+            std::cerr << "Failed to write page " << page << " of stream " << stream_index << " in '" << _pdb_file << "'. Error: " << errno << std::endl;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int pdb_generator_t::generate()
+{
+    pdb_stream_header_t pdb_header;
+    tpi_header_t tpi_header;
+    dbi_header_t dbi_header;
+    pdb_header_t header;
+    uint32_t stream;
+
+    _streams.resize(type_filler + _options.filler_streams);
+
+    pdb_header.version = 19970604;
+    pdb_header.signature = _options.seed;
+    pdb_header.age = 1;
+    _streams[type_pdb_header_t].assign((char const *)&pdb_header, sizeof(pdb_header));
+
+    tpi_header.version = 19961031;
+    tpi_header.header_size = sizeof(tpi_header);
+    tpi_header.min_ti = 0x1000;
+    tpi_header.max_ti = 0x1000;
+    tpi_header.size = 0;
+    _streams[type_tpi].assign((char const *)&tpi_header, sizeof(tpi_header));
+
+    memset(&dbi_header, 0, sizeof(dbi_header));
+    dbi_header.signature = 0xFFFFFFFF;
+    dbi_header.version = 19970606;
+    dbi_header.age = 1;
+    dbi_header.global_symbols_stream = type_gs;
+    dbi_header.private_symbols_stream = type_ps;
+    dbi_header.symbols_stream = type_sym;
+    _streams[type_dbi].assign((char const *)&dbi_header, sizeof(dbi_header));
+
+    _streams[type_fpo].assign(16, '\0');
+    _streams[type_gs].assign(16, '\0');
+    _streams[type_ps].assign(16, '\0');
+
+    build_symbols();
+    build_modules(&dbi_header);
+    build_types(&tpi_header);
+
+    if (layout() == -1)
+    {
+        return -1;
+    }
+
+    _pdb_stream = fopen(_pdb_file.c_str(), "wb");
+    if (_pdb_stream == 0)
+    {
+        std::cerr << "Cannot open file '" << _pdb_file << "'. Error : " << errno << std::endl;
+        return -1;
+    }
+
+    /* The reader checks the file size against the number of pages */
+    if (ftruncate(fileno(_pdb_stream), (off_t)_file_pages * _options.page_size) == -1)
+    {
+        std::cerr << "Failed to size '" << _pdb_file << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    header.page_size = _options.page_size;
+    header.start_page = 0x2;
+    header.file_pages = _file_pages;
+    header.root_stream.stream_size = _sizes[type_root_t];
+    header.root_stream.stream_page[0] = 0;
+    header.root_stream.stream_page[1] = 0;
+
+    if (fwrite(PDB_SIGNATURE_200, PDB_SIGNATURE_200_SIZE, 1, _pdb_stream) != 1 ||
+        fwrite(&header, sizeof(header), 1, _pdb_stream) != 1 ||
+        fwrite(&_root_pages[0], _root_pages.size() * sizeof(uint16_t), 1, _pdb_stream) != 1)
+    {
+        std::cerr << "Failed to write PDB header of '" << _pdb_file << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    if (write_stream(type_root_t, _streams[type_root_t], _root_pages) == -1)
+    {
+        return -1;
+    }
+
+    for (stream = 0; stream < _streams.size(); ++stream)
+    {
+        int ret = (stream < type_filler ? write_stream(stream, _streams[stream], _pages[stream]) : write_filler(stream));
+
+        if (ret == -1)
+        {
+            return -1;
+        }
+    }
+
+    if (fclose(_pdb_stream) != 0)
+    {
+        _pdb_stream = 0;
+        std::cerr << "Failed to write '" << _pdb_file << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    _pdb_stream = 0;
+    return 0;
+}
+
+static int parse_size(char const * const size, uint64_t * bytes)
+{
+    char * end;
+    unsigned long long value;
+
+    errno = 0;
+    value = strtoull(size, &end, 10);
+    if (errno != 0 || end == size)
+    {
+        return -1;
+    }
+
+    switch (*end)
+    {
+        case 'G':
+            value *= 1024;
+            /* Fall through */
+        case 'M':
+            value *= 1024;
+            /* Fall through */
+        case 'K':
+            value *= 1024;
+            ++end;
+            break;
+    }
+
+    if (*end != 0)
+    {
+        return -1;
+    }
+
+    *bytes = value;
+    return 0;
+}
+
+static void usage(char const * const program)
+{
+    std::cerr << "Usage: " << program << " [options] file.pdb\n"
+                 "  --page-size=SIZE        page size: 1024, 2048 or 4096 (default: 4096)\n"
+                 "  --symbols=COUNT         number of symbols (default: 10000)\n"
+                 "  --name-length=MIN:MAX   symbol name lengths, uniformly distributed, at least their decoration (default: 8:64)\n"
+                 "  --padding=PERCENT       symbol records preceded by padding, per 100 records (default: 0)\n"
+                 "  --modules=COUNT         number of modules, sharing the symbols segments (default: 0)\n"
+                 "  --templates=PERCENT     symbols named after templates, per 100 symbols (default: 0)\n"
+                 "  --types=COUNT           number of structures, and their functions (default: 0)\n"
+                 "  --renumber=SEED         structures written in another order, at other type indexes (default: 0, none)\n"
+                 "  --size=SIZE[K|M|G]      file size to reach with filler streams\n"
+                 "  --streams=COUNT         number of filler streams (default: 1 with --size, 0 otherwise)\n"
+                 "  --fragmentation=PERCENT pages swapped around, per 100 pages (default: 0)\n"
+                 "  --seed=SEED             random seed (default: 0)" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    int idx;
+    generator_options_t options;
+    char const * pdb_file = 0;
+    bool filler_streams = false;
+
+    options.page_size = 0x1000;
+    options.symbols = 10000;
+    options.min_name_length = 8;
+    options.max_name_length = 64;
+    options.padding = 0;
+    options.modules = 0;
+    options.templates = 0;
+    options.types = 0;
+    options.renumber = 0;
+    options.filler_streams = 0;
+    options.file_size = 0;
+    options.fragmentation = 0;
+    options.seed = 0;
+
+    for (idx = 1; idx < argc; ++idx)
+    {
+        if (sscanf(argv[idx], "--page-size=%u", &options.page_size) == 1)
+        {
+            if (options.page_size != 0x400 && options.page_size != 0x800 && options.page_size != 0x1000)
+            {
+                std::cerr << "Invalid page size: " << options.page_size << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--symbols=%u", &options.symbols) == 1)
+        {
+        }
+        else if (sscanf(argv[idx], "--name-length=%u:%u", &options.min_name_length, &options.max_name_length) == 2)
+        {
+            /* Lengths are stored on a byte */
+            if (options.min_name_length == 0 || options.min_name_length > options.max_name_length || options.max_name_length > 0xFF)
+            {
+                std::cerr << "Invalid name lengths: " << argv[idx] + 14 << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--padding=%u", &options.padding) == 1)
+        {
+            if (options.padding > 100)
+            {
+                std::cerr << "Invalid padding: " << options.padding << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--modules=%u", &options.modules) == 1)
+        {
+        }
+        else if (sscanf(argv[idx], "--templates=%u", &options.templates) == 1)
+        {
+            if (options.templates > 100)
+            {
+                std::cerr << "Invalid templates percentage: " << options.templates << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--types=%u", &options.types) == 1)
+        {
+        }
+        else if (sscanf(argv[idx], "--renumber=%u", &options.renumber) == 1)
+        {
+        }
+        else if (strncmp(argv[idx], "--size=", 7) == 0)
+        {
+            if (parse_size(argv[idx] + 7, &options.file_size) == -1)
+            {
+                std::cerr << "Invalid file size: " << argv[idx] + 7 << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--streams=%u", &options.filler_streams) == 1)
+        {
+            filler_streams = true;
+        }
+        else if (sscanf(argv[idx], "--fragmentation=%u", &options.fragmentation) == 1)
+        {
+            if (options.fragmentation > 100)
+            {
+                std::cerr << "Invalid fragmentation: " << options.fragmentation << std::endl;
+                return 1;
+            }
+        }
+        else if (sscanf(argv[idx], "--seed=%u", &options.seed) == 1)
+        {
+        }
+        else if (strncmp(argv[idx], "--", 2) == 0 || pdb_file != 0)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            pdb_file = argv[idx];
+        }
+    }
+
+    if (pdb_file == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!filler_streams && options.file_size != 0)
+    {
+        options.filler_streams = 1;
+    }
+
+    pdb_generator_t generator(pdb_file, options);
+    if (generator.generate() == -1)
+    {
+        return 1;
+    }
+
+    return 0;
+}
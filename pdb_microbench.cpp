@@ -0,0 +1,192 @@
+/*
+* pdb_microbench - Micro-benchmarks for pdb_viewer symbol records decoding
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* It times read_stream_sym() alone, over synthetic symbol streams kept in
+* memory: no I/O, no output.
+*/
+
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#include "pdb_view.h"
+#include "pdb_synth.h"
+
+struct microbench_case_t
+{
+    char const * name;
+    uint32_t min_name_length;
+    uint32_t max_name_length;
+    uint32_t padding;
+    uint32_t unique_names;
+};
+
+static microbench_case_t const microbench_cases[] =
+{
+    { "short_names", 4, 8, 0, 0 },
+    { "medium_names", 16, 32, 0, 0 },
+    { "long_names", 128, 255, 0, 0 },
+    { "mixed_names", 4, 255, 0, 0 },
+    { "padded_25", 16, 32, 25, 0 },
+    { "padded_100", 16, 32, 100, 0 },
+    { "duplicate_names", 16, 32, 0, 1024 },
+};
+
+struct microbench_options_t
+{
+    uint32_t records;
+    uint32_t iterations;
+    char const * filter;
+};
+
+class pdb_microbench_t
+{
+public:
+    pdb_microbench_t(microbench_options_t const & options);
+
+    int run(microbench_case_t const & bench_case);
+
+private:
+    microbench_options_t const & _options;
+    pdb_options_t _pdb_options;
+};
+
+pdb_microbench_t::pdb_microbench_t(microbench_options_t const & options) : _options(options)
+{
+}
+
+int pdb_microbench_t::run(microbench_case_t const & bench_case)
+{
+    typedef std::chrono::steady_clock clock_t;
+    std::mt19937 random(0);
+    synth_symbols_t params;
+    std::string synthesized;
+    std::vector<uint64_t> samples;
+    pdb_stream_t stream;
+    void * stream_buffer;
+    uint32_t iteration;
+    double median;
+
+    params.symbols = _options.records;
+    params.min_name_length = bench_case.min_name_length;
+    params.max_name_length = bench_case.max_name_length;
+    params.padding = bench_case.padding;
+    params.unique_names = bench_case.unique_names;
+    params.templates = 0;
+    synth_symbol_stream(synthesized, random, params);
+
+    /* Records alignment is checked on addresses, the buffer must be aligned like stream buffers are */
+    stream.stream_size = synthesized.size();
+    stream_buffer = buffer_pool_t::instance().acquire(stream.stream_size);
+    if (stream_buffer == 0)
+    {
+        std::cerr << "Memory allocation failure for " << stream.stream_size << "B" << std::endl;
+        return -1;
+    }
+    memcpy(stream_buffer, synthesized.data(), synthesized.size());
+
+    for (iteration = 0; iteration < _options.iterations + 1; ++iteration)
+    {
+        /* Fresh file each time, so that names are interned from scratch */
+        pdb_file_t pdb_file(bench_case.name, _pdb_options);
+        clock_t::time_point start;
+        uint64_t elapsed;
+
+        start = clock_t::now();
+        pdb_file.decode_symbols(stream_buffer, stream.stream_size);
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+
+        if (pdb_file.symbols_count() != _options.records)
+        {
+            std::cerr << "Decoded " << pdb_file.symbols_count() << " symbols out of " << _options.records << " in " << bench_case.name << std::endl;
+            buffer_pool_t::instance().release(stream_buffer, stream.stream_size);
+            return -1;
+        }
+
+        /* First one is warmup */
+        if (iteration != 0)
+        {
+            samples.push_back(elapsed);
+        }
+    }
+
+    buffer_pool_t::instance().release(stream_buffer, stream.stream_size);
+
+    std::sort(samples.begin(), samples.end());
+    median = samples[samples.size() / 2];
+    printf("%-16s %10u %12u %12.2f %12.2f %12.2f %10.1f\n", bench_case.name, _options.records, stream.stream_size,
+           (double)samples.front() / _options.records, median / _options.records, (double)samples.back() / _options.records,
+           stream.stream_size / (median / 1e9) / (1024 * 1024));
+
+    return 0;
+}
+
+static void usage(char const * const program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+                 "  --records=COUNT     symbol records per stream (default: 100000)\n"
+                 "  --iterations=COUNT  measured decodings per case (default: 20)\n"
+                 "  --filter=TEXT       only run the cases whose name contains TEXT" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    int idx;
+    uint32_t bench_case;
+    microbench_options_t options;
+
+    options.records = 100000;
+    options.iterations = 20;
+    options.filter = 0;
+
+    for (idx = 1; idx < argc; ++idx)
+    {
+        if (sscanf(argv[idx], "--records=%u", &options.records) == 1)
+        {
+        }
+        else if (sscanf(argv[idx], "--iterations=%u", &options.iterations) == 1 && options.iterations != 0)
+        {
+        }
+        else if (strncmp(argv[idx], "--filter=", 9) == 0)
+        {
+            options.filter = argv[idx] + 9;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    pdb_microbench_t microbench(options);
+
+    printf("%-16s %10s %12s %12s %12s %12s %10s\n", "case", "records", "bytes", "min ns/rec", "p50 ns/rec", "max ns/rec", "MB/s");
+    for (bench_case = 0; bench_case < sizeof(microbench_cases) / sizeof(microbench_cases[0]); ++bench_case)
+    {
+        if (options.filter != 0 && strstr(microbench_cases[bench_case].name, options.filter) == 0)
+        {
+            continue;
+        }
+
+        if (microbench.run(microbench_cases[bench_case]) == -1)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,379 @@
+/*
+* pdb_synth - Synthetic PDB streams
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Shared by pdb_generator, which writes them in files, and pdb_microbench,
+* which decodes them from memory.
+*/
+
+#ifndef PDB_SYNTH_H
+#define PDB_SYNTH_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+struct synth_symbols_t
+{
+    uint32_t symbols;
+    uint32_t min_name_length;
+    uint32_t max_name_length;
+    /* Records preceded by padding words, per 100 records */
+    uint32_t padding;
+    /* Size of the pool names are drawn from, 0 for all distinct names */
+    uint32_t unique_names;
+    /* Names of templates and their members, per 100 names */
+    uint32_t templates;
+};
+
+template <typename type_t>
+static inline void synth_append(std::string & stream, type_t value)
+{
+    stream.append((char const *)&value, sizeof(value));
+}
+
+/* Mangled like names: ?identifier@namespace@@YAXXZ, so that names share prefixes and suffixes.
+ * Names are never shorter than their decoration and a one character identifier */
+static inline std::string synth_name(std::mt19937 & random, uint32_t length)
+{
+    static char const charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    static char const * const namespaces[] = { "std", "detail", "core", "io", "ui", "net", "util", "impl" };
+    std::uniform_int_distribution<uint32_t> character(0, sizeof(charset) - 2);
+    std::uniform_int_distribution<uint32_t> scope(0, sizeof(namespaces) / sizeof(namespaces[0]) - 1);
+    std::string name("?");
+    std::string suffix("@");
+
+    suffix += namespaces[scope(random)];
+    suffix += "@@YAXXZ";
+
+    do
+    {
+        name += charset[character(random)];
+    }
+    while (name.size() + suffix.size() < length);
+
+    return name + suffix;
+}
+
+/* Template like names: ?identifier@?$template@arguments@namespace@@QEAAXXZ
+ * for members, and some constructors (??0?$template@...) and function
+ * templates (??$identifier@arguments@namespace@@YAXXZ) */
+static inline std::string synth_template_name(std::mt19937 & random, uint32_t length)
+{
+    static char const charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    static char const * const templates[] = { "vector", "map", "array", "span", "optional", "function" };
+    static char const * const arguments[] = { "H", "M", "_N", "PEAD", "V?$allocator@H@std@@", "H$0BA@" };
+    static char const * const namespaces[] = { "std", "detail", "core" };
+    std::uniform_int_distribution<uint32_t> character(0, sizeof(charset) - 2);
+    std::uniform_int_distribution<uint32_t> form(0, 3);
+    std::uniform_int_distribution<uint32_t> scope(0, sizeof(namespaces) / sizeof(namespaces[0]) - 1);
+    std::uniform_int_distribution<uint32_t> argument(0, sizeof(arguments) / sizeof(arguments[0]) - 1);
+    std::uniform_int_distribution<uint32_t> pattern(0, sizeof(templates) / sizeof(templates[0]) - 1);
+    std::string instance("?$");
+    std::string name;
+    std::string suffix;
+
+    instance += templates[pattern(random)];
+    instance += '@';
+    instance += arguments[argument(random)];
+    instance += '@';
+    instance += namespaces[scope(random)];
+    instance += "@@";
+
+    switch (form(random))
+    {
+        case 0:
+            return "??0" + instance + "QEAA@XZ";
+
+        case 1:
+            name = "??$";
+            suffix = "@";
+            suffix += arguments[argument(random)];
+            suffix += '@';
+            suffix += namespaces[scope(random)];
+            suffix += "@@YAXXZ";
+            break;
+
+        default:
+            name = "?";
+            suffix = "@" + instance + "QEAAXXZ";
+            break;
+    }
+
+    do
+    {
+        name += charset[character(random)];
+    }
+    while (name.size() + suffix.size() < length);
+
+    return name + suffix;
+}
+
+static inline std::string synth_symbol_name(std::mt19937 & random, synth_symbols_t const & params, uint32_t length)
+{
+    if (params.templates != 0 && std::uniform_int_distribution<uint32_t>(0, 99)(random) < params.templates)
+    {
+        return synth_template_name(random, length);
+    }
+
+    return synth_name(random, length);
+}
+
+/* Symbol stream as read_stream_sym() walks it: a leading 16-bit word, then
+ * records (version, type, offset, segment, length prefixed name) aligned on
+ * 16-bit. Offsets increase within each of the four segments, from 0x1000 to
+ * the segment ends, indexed from 1, if wanted */
+static inline void synth_symbol_stream(std::string & stream, std::mt19937 & random, synth_symbols_t const & params, uint32_t * const segment_ends = 0)
+{
+    std::uniform_int_distribution<uint32_t> name_length(params.min_name_length, params.max_name_length);
+    std::uniform_int_distribution<uint32_t> segment(1, 4);
+    std::uniform_int_distribution<uint32_t> gap(1, 16);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    std::uniform_int_distribution<uint32_t> padding_words(1, 2);
+    uint32_t offsets[5] = { 0, 0x1000, 0x1000, 0x1000, 0x1000 };
+    std::vector<std::string> pool;
+    uint32_t symbol;
+
+    for (symbol = 0; symbol < params.unique_names; ++symbol)
+    {
+        pool.push_back(synth_symbol_name(random, params, name_length(random)));
+    }
+
+    stream.assign(sizeof(uint16_t), 0);
+
+    for (symbol = 0; symbol < params.symbols; ++symbol)
+    {
+        std::string name;
+        uint16_t record_segment;
+
+        if (pool.empty())
+        {
+            name = synth_symbol_name(random, params, name_length(random));
+        }
+        else
+        {
+            name = pool[std::uniform_int_distribution<uint32_t>(0, pool.size() - 1)(random)];
+        }
+
+        record_segment = segment(random);
+
+        /* Padding the reader skips before records */
+        if (params.padding != 0 && percent(random) < params.padding)
+        {
+            stream.append(padding_words(random) * sizeof(uint16_t), '\0');
+        }
+
+        synth_append<uint16_t>(stream, 0x1009);
+        synth_append<uint32_t>(stream, 0);
+        synth_append<uint32_t>(stream, offsets[record_segment]);
+        synth_append<uint16_t>(stream, record_segment);
+        offsets[record_segment] += gap(random) * 0x10;
+
+        stream += (char)name.size();
+        stream += name;
+
+        if (stream.size() & 1)
+        {
+            stream += '\0';
+        }
+    }
+
+    if (segment_ends != 0)
+    {
+        std::copy(offsets + 1, offsets + 5, segment_ends + 1);
+    }
+}
+
+/* Type record: its length, not counting itself, the leaf kind and data,
+ * padded on 32-bit with LF_PAD bytes */
+static inline void synth_type_record(std::string & stream, uint16_t kind, std::string const & data)
+{
+    uint32_t padding = (4 - (2 * sizeof(uint16_t) + data.size()) % 4) % 4;
+
+    synth_append<uint16_t>(stream, sizeof(uint16_t) + data.size() + padding);
+    synth_append<uint16_t>(stream, kind);
+    stream += data;
+    for (; padding != 0; --padding)
+    {
+        stream += (char)(0xF0 + padding);
+    }
+}
+
+/* Structures of the types universe: the structure with a given number is
+ * the same in every file, its members are basic types or pointers to
+ * structures with lower numbers */
+class synth_types_t
+{
+public:
+    explicit synth_types_t(std::string & stream) : _stream(stream), _next_ti(0x1000) {}
+
+    /* Emits the structure, after the ones it references, and a function
+     * taking a pointer to it. Returns its pointer type */
+    uint32_t structure(uint32_t number)
+    {
+        static uint32_t const basic_types[] = { 0x70, 0x74, 0x75, 0x40, 0x41, 0x13, 0x23 };
+        std::mt19937 random(number);
+        std::uniform_int_distribution<uint32_t> members(1, 8);
+        std::uniform_int_distribution<uint32_t> basic(0, sizeof(basic_types) / sizeof(basic_types[0]) - 1);
+        std::uniform_int_distribution<uint32_t> percent(0, 99);
+        std::vector<uint32_t> types;
+        std::string fields;
+        std::string data;
+        uint32_t count;
+        uint32_t member;
+        uint32_t field_list;
+        uint32_t pointer;
+        char name[32];
+
+        if (_pointers.size() > number && _pointers[number] != 0)
+        {
+            return _pointers[number];
+        }
+
+        count = members(random);
+        for (member = 0; member < count; ++member)
+        {
+            if (number != 0 && percent(random) < 30)
+            {
+                types.push_back(std::uniform_int_distribution<uint32_t>(0, number - 1)(random));
+                types.back() = structure(types.back());
+            }
+            else
+            {
+                types.push_back(basic_types[basic(random)]);
+            }
+        }
+
+        /* Members: attributes, type, offset and name */
+        for (member = 0; member < count; ++member)
+        {
+            synth_append<uint16_t>(fields, 0x150D);
+            synth_append<uint16_t>(fields, 3);
+            synth_append<uint32_t>(fields, types[member]);
+            synth_append<uint16_t>(fields, member * 8);
+            snprintf(name, sizeof(name), "member%u", member);
+            fields.append(name, strlen(name) + 1);
+            while (fields.size() % 4 != 0)
+            {
+                fields += (char)(0xF0 + 4 - fields.size() % 4);
+            }
+        }
+
+        field_list = emit(0x1203, fields);
+
+        /* Members count, properties, field list, derived classes, virtual table shape, size, name */
+        synth_append<uint16_t>(data, count);
+        synth_append<uint16_t>(data, 0);
+        synth_append<uint32_t>(data, field_list);
+        synth_append<uint32_t>(data, 0);
+        synth_append<uint32_t>(data, 0);
+        synth_append<uint16_t>(data, count * 8);
+        snprintf(name, sizeof(name), "structure%u", number);
+        data.append(name, strlen(name) + 1);
+        types.assign(1, emit(0x1505, data));
+
+        /* 64-bit pointer to it */
+        data.clear();
+        synth_append<uint32_t>(data, types[0]);
+        synth_append<uint32_t>(data, 0x1000C);
+        pointer = emit(0x1002, data);
+
+        /* void function(structure *, int) */
+        data.clear();
+        synth_append<uint32_t>(data, 2);
+        synth_append<uint32_t>(data, pointer);
+        synth_append<uint32_t>(data, 0x74);
+        types[0] = emit(0x1201, data);
+        data.clear();
+        synth_append<uint32_t>(data, 0x03);
+        synth_append<uint8_t>(data, 0);
+        synth_append<uint8_t>(data, 0);
+        synth_append<uint16_t>(data, 2);
+        synth_append<uint32_t>(data, types[0]);
+        emit(0x1008, data);
+
+        if (_pointers.size() <= number)
+        {
+            _pointers.resize(number + 1, 0);
+        }
+        _pointers[number] = pointer;
+        return pointer;
+    }
+
+    uint32_t types() const { return _next_ti - 0x1000; }
+
+private:
+    uint32_t emit(uint16_t kind, std::string const & data)
+    {
+        synth_type_record(_stream, kind, data);
+        return _next_ti++;
+    }
+
+    std::string & _stream;
+    uint32_t _next_ti;
+    /* Pointer type of each structure emitted */
+    std::vector<uint32_t> _pointers;
+};
+
+/* TPI stream records, of structures drawn from a universe twice as large,
+ * in random order: files share most of their types, with different type
+ * indexes. With a renumber seed, the same structures are written in another
+ * order. The stream is to start with its header. Returns how many records
+ * were added, and the pointer type of each structure drawn, if wanted */
+static inline uint32_t synth_type_stream(std::string & stream, std::mt19937 & random, uint32_t structures, uint32_t renumber = 0, std::vector<uint32_t> * const pointers = 0)
+{
+    std::vector<uint32_t> numbers(2 * structures);
+    synth_types_t types(stream);
+    uint32_t structure;
+
+    for (structure = 0; structure < numbers.size(); ++structure)
+    {
+        numbers[structure] = structure;
+    }
+
+    std::shuffle(numbers.begin(), numbers.end(), random);
+    numbers.resize(structures);
+
+    if (renumber != 0)
+    {
+        std::vector<uint32_t> order(numbers);
+        std::mt19937 renumber_random(renumber);
+
+        std::shuffle(order.begin(), order.end(), renumber_random);
+        for (structure = 0; structure < structures; ++structure)
+        {
+            types.structure(order[structure]);
+        }
+    }
+
+    for (structure = 0; structure < structures; ++structure)
+    {
+        uint32_t pointer = types.structure(numbers[structure]);
+
+        if (pointers != 0)
+        {
+            pointers->push_back(pointer);
+        }
+    }
+
+    return types.types();
+}
+
+#endif
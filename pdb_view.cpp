@@ -0,0 +1,4898 @@
+/*
+* pdb_view - A library for reading PDB files
+* Copyright (C) 2015 Pierre Schweitzer <pierre@reactos.org>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* This work is based on:
+* Schreiber, Sven B. Undocumented Windows 2000 secrets: a programmer's cookbook. Reading: Addison-Wesley, 2001.
+* ISBN: 0201721872
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sstream>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdarg>
+#include <algorithm>
+#include <queue>
+#include <unordered_set>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "pdb_view.h"
+
+bool perf_counting = false;
+bool heap_accounting = false;
+thread_local heap_usage_t heap_usage;
+
+static inline uint32_t min(uint32_t a, uint32_t b)
+{
+    if (a > b) return b;
+    return a;
+}
+
+pdb_options_t::pdb_options_t()
+{
+    stats = false;
+    stats_files = false;
+    memory_budget = 0;
+    compress_index = false;
+    io_backend = io_backend_stdio;
+    jobs = 1;
+    stream_jobs = 1;
+    histograms = false;
+}
+
+static void print_format(std::ostream & out, char const * const format, ...)
+{
+    char buffer[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    out << buffer;
+}
+
+static std::string phase_name(uint32_t phase)
+{
+    switch (phase)
+    {
+        case phase_header:
+            return "header";
+
+        case phase_root:
+            return "root";
+
+        case phase_prefetch:
+            return "prefetch";
+
+        case phase_index:
+            return "index";
+
+        case phase_output:
+            return "output";
+
+        default:
+            break;
+    }
+
+    if (phase < phase_decode)
+    {
+        return std::string("fetch_") + stream_kind_names[phase - phase_fetch];
+    }
+
+    return std::string("decode_") + stream_kind_names[phase - phase_decode];
+}
+
+phase_stats_t::phase_stats_t()
+{
+    count = 0;
+    elapsed_ns = 0;
+    allocated_bytes = 0;
+    peak_heap_bytes = 0;
+    perf_count = 0;
+    std::fill(perf_values, perf_values + perf_counters_count, 0);
+}
+
+void phase_stats_t::add(phase_stats_t const & stats)
+{
+    count += stats.count;
+    elapsed_ns += stats.elapsed_ns;
+    allocated_bytes += stats.allocated_bytes;
+    peak_heap_bytes = std::max(peak_heap_bytes, stats.peak_heap_bytes);
+    perf_count += stats.perf_count;
+    for (uint32_t counter = 0; counter < perf_counters_count; ++counter)
+    {
+        perf_values[counter] += stats.perf_values[counter];
+    }
+}
+
+std::atomic<bool> perf_counters_t::_warned(false);
+
+perf_counters_t::perf_counters_t()
+{
+    _opened = false;
+    std::fill(_fds, _fds + perf_counters_count, -1);
+}
+
+perf_counters_t::~perf_counters_t()
+{
+    uint32_t counter;
+
+    for (counter = 0; counter < perf_counters_count; ++counter)
+    {
+        if (_fds[counter] != -1)
+        {
+            ::close(_fds[counter]);
+        }
+    }
+}
+
+perf_counters_t & perf_counters_t::instance()
+{
+    static thread_local perf_counters_t counters;
+
+    return counters;
+}
+
+int perf_counters_t::open_counters()
+{
+    static const uint64_t configs[perf_counters_count] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                           PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    struct perf_event_attr attr;
+    uint32_t counter;
+
+    for (counter = 0; counter < perf_counters_count; ++counter)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[counter];
+        attr.read_format = PERF_FORMAT_GROUP;
+        /* User space only, allowed with the default perf_event_paranoid */
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        /* The leader starts the group */
+        attr.disabled = (counter == 0);
+
+        _fds[counter] = syscall(__NR_perf_event_open, &attr, 0, -1, counter == 0 ? -1 : _fds[0], 0);
+        if (_fds[counter] == -1)
+        {
+            if (!_warned.exchange(true))
+            {
+                std::cerr << "Hardware counters unavailable, not counting them. Error: " << errno << std::endl;
+            }
+
+            return -1;
+        }
+    }
+
+    if (ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+bool perf_counters_t::read(uint64_t * values)
+{
+    uint64_t group[1 + perf_counters_count];
+
+    if (!_opened)
+    {
+        _opened = true;
+        if (open_counters() == -1)
+        {
+            ::close(_fds[0]);
+            _fds[0] = -1;
+        }
+    }
+
+    /* Values follow their count */
+    if (_fds[0] == -1 || ::read(_fds[0], group, sizeof(group)) != sizeof(group))
+    {
+        return false;
+    }
+
+    std::copy(group + 1, group + 1 + perf_counters_count, values);
+    return true;
+}
+
+/* Time spent in I/O (fetching streams) and in decoding, then each phase */
+static void print_phases(std::ostream & err, phase_stats_t const * const phases)
+{
+    uint64_t io_ns = phases[phase_prefetch].elapsed_ns;
+    uint64_t decode_ns = 0;
+    uint32_t phase;
+
+    for (phase = 0; phase < stream_kinds_count; ++phase)
+    {
+        io_ns += phases[phase_fetch + phase].elapsed_ns;
+        decode_ns += phases[phase_decode + phase].elapsed_ns;
+    }
+
+    print_format(err, "I/O: %.3fms, decoding: %.3fms\n", io_ns / 1e6, decode_ns / 1e6);
+    print_format(err, "%-18s %10s %12s %12s %14s %14s\n", "phase", "count", "total ms", "mean us", "allocated KB", "peak heap KB");
+    for (phase = 0; phase < phases_count; ++phase)
+    {
+        if (phases[phase].count == 0)
+        {
+            continue;
+        }
+
+        print_format(err, "%-18s %10" PRIu64 " %12.3f %12.3f %14" PRIu64 " %14" PRIu64 "\n", phase_name(phase).c_str(), phases[phase].count,
+                     phases[phase].elapsed_ns / 1e6, phases[phase].elapsed_ns / 1e3 / phases[phase].count, phases[phase].allocated_bytes / 1024,
+                     phases[phase].peak_heap_bytes / 1024);
+    }
+
+    /* Nothing when the counters couldn't be opened */
+    for (phase = 0; phase < phases_count && phases[phase].perf_count == 0; ++phase)
+    {
+    }
+
+    if (phase == phases_count)
+    {
+        return;
+    }
+
+    print_format(err, "%-18s %10s %14s %14s %8s %14s %14s\n", "phase", "counted", perf_counter_names[perf_cycles], perf_counter_names[perf_instructions], "IPC",
+                 perf_counter_names[perf_cache_misses], perf_counter_names[perf_branch_misses]);
+    for (phase = 0; phase < phases_count; ++phase)
+    {
+        uint64_t const * values = phases[phase].perf_values;
+
+        if (phases[phase].perf_count == 0)
+        {
+            continue;
+        }
+
+        print_format(err, "%-18s %10" PRIu64 " %14" PRIu64 " %14" PRIu64 " %8.2f %14" PRIu64 " %14" PRIu64 "\n", phase_name(phase).c_str(), phases[phase].perf_count,
+                     values[perf_cycles], values[perf_instructions], values[perf_cycles] != 0 ? (double)values[perf_instructions] / values[perf_cycles] : 0.0,
+                     values[perf_cache_misses], values[perf_branch_misses]);
+    }
+}
+
+static void print_io_header(std::ostream & err)
+{
+    print_format(err, "%-18s %10s %10s %12s %12s %10s %10s\n", "stream", "syscalls", "seeks", "read KB", "copied KB", "pages", "cached");
+}
+
+static void print_io_stats(std::ostream & err, std::string const & name, io_stats_t const & stats)
+{
+    print_format(err, "%-18s %10" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", name.c_str(), stats.syscalls,
+                 stats.seeks, stats.bytes_read / 1024, stats.bytes_copied / 1024, stats.pages, stats.cached_pages);
+}
+
+/* Escaped for JSON strings */
+static std::string json_escape(std::string const & text)
+{
+    std::string escaped;
+    char buffer[8];
+
+    for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+    {
+        if (*it == '"' || *it == '\\')
+        {
+            escaped += '\\';
+            escaped += *it;
+        }
+        else if ((unsigned char)*it < 0x20)
+        {
+            snprintf(buffer, sizeof(buffer), "\\u%04x", *it);
+            escaped += buffer;
+        }
+        else
+        {
+            escaped += *it;
+        }
+    }
+
+    return escaped;
+}
+
+bool trace_t::_enabled = false;
+std::chrono::steady_clock::time_point trace_t::_epoch;
+std::atomic<uint32_t> trace_t::_threads(0);
+std::mutex trace_t::_lock;
+std::vector<trace_event_t> trace_t::_events;
+
+trace_t::thread_events_t::thread_events_t()
+{
+    thread = _threads++;
+}
+
+trace_t::thread_events_t::~thread_events_t()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    _events.insert(_events.end(), events.begin(), events.end());
+}
+
+trace_t::thread_events_t & trace_t::thread_events()
+{
+    static thread_local thread_events_t events;
+
+    return events;
+}
+
+void trace_t::enable()
+{
+    _epoch = std::chrono::steady_clock::now();
+    _enabled = true;
+}
+
+uint64_t trace_t::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+}
+
+void trace_t::record(trace_event_t & event)
+{
+    thread_events_t & events = thread_events();
+
+    event.thread = events.thread;
+    events.events.push_back(std::move(event));
+}
+
+int trace_t::write(char const * const file)
+{
+    thread_events_t & events = thread_events();
+    FILE * trace;
+    bool first = true;
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        _events.insert(_events.end(), events.events.begin(), events.events.end());
+        events.events.clear();
+    }
+
+    trace = fopen(file, "w");
+    if (trace == 0)
+    {
+        return -1;
+    }
+
+    /* Complete events, timestamps in microseconds */
+    fprintf(trace, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (std::vector<trace_event_t>::const_iterator it = _events.begin(); it != _events.end(); ++it)
+    {
+        fprintf(trace, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f%s%s}", first ? "" : ",\n",
+                json_escape(it->name).c_str(), it->category, (int)getpid(), it->thread, it->start_ns / 1e3, it->duration_ns / 1e3,
+                it->args.empty() ? "" : ",\"args\":", it->args.c_str());
+        first = false;
+    }
+    fprintf(trace, "\n]}\n");
+
+    if (fclose(trace) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+trace_span_t::trace_span_t()
+{
+    _active = false;
+}
+
+trace_span_t::~trace_span_t()
+{
+    if (!_active)
+    {
+        return;
+    }
+
+    _event.duration_ns = trace_t::now() - _event.start_ns;
+    trace_t::record(_event);
+}
+
+void trace_span_t::begin(char const * category, std::string const & name, std::string const & args)
+{
+    _active = true;
+    _event.name = name;
+    _event.category = category;
+    _event.args = args;
+    _event.start_ns = trace_t::now();
+}
+
+std::mutex phase_scope_t::_totals_lock;
+phase_stats_t phase_scope_t::_totals[phases_count];
+
+phase_scope_t::phase_scope_t(phase_stats_t * phases, uint32_t phase, int32_t stream_index)
+{
+    if (trace_t::enabled())
+    {
+        _span.begin("phase", phase_name(phase), stream_index < 0 ? std::string() : "{\"stream\":" + std::to_string(stream_index) + "}");
+    }
+
+    _stats = (phases != 0 ? &phases[phase] : 0);
+    if (_stats == 0)
+    {
+        return;
+    }
+
+    /* Phases don't nest, the peak is restored when leaving */
+    _allocated_bytes = heap_usage.allocated_bytes;
+    _in_use_bytes = heap_usage.in_use_bytes;
+    _peak_in_use_bytes = heap_usage.peak_in_use_bytes;
+    heap_usage.peak_in_use_bytes = heap_usage.in_use_bytes;
+    _start = std::chrono::steady_clock::now();
+    _counting = (perf_counting && perf_counters_t::instance().read(_perf_values));
+}
+
+phase_scope_t::~phase_scope_t()
+{
+    std::chrono::steady_clock::time_point end;
+    uint64_t values[perf_counters_count];
+    uint32_t counter;
+
+    if (_stats == 0)
+    {
+        return;
+    }
+
+    if (_counting)
+    {
+        perf_counters_t::instance().read(values);
+    }
+
+    end = std::chrono::steady_clock::now();
+    ++_stats->count;
+    _stats->elapsed_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count();
+
+    if (_counting)
+    {
+        ++_stats->perf_count;
+        for (counter = 0; counter < perf_counters_count; ++counter)
+        {
+            _stats->perf_values[counter] += values[counter] - _perf_values[counter];
+        }
+    }
+
+    _stats->allocated_bytes += heap_usage.allocated_bytes - _allocated_bytes;
+    _stats->peak_heap_bytes = std::max(_stats->peak_heap_bytes, (uint64_t)(heap_usage.peak_in_use_bytes - _in_use_bytes));
+    heap_usage.peak_in_use_bytes = std::max(heap_usage.peak_in_use_bytes, _peak_in_use_bytes);
+}
+
+void phase_scope_t::add_totals(phase_stats_t const * const phases)
+{
+    std::lock_guard<std::mutex> lock(_totals_lock);
+    uint32_t phase;
+
+    for (phase = 0; phase < phases_count; ++phase)
+    {
+        _totals[phase].add(phases[phase]);
+    }
+}
+
+void phase_scope_t::totals(phase_stats_t * phases)
+{
+    std::lock_guard<std::mutex> lock(_totals_lock);
+
+    std::copy(_totals, _totals + phases_count, phases);
+}
+
+buffer_pool_stats_t::buffer_pool_stats_t()
+{
+    requests = 0;
+    heap_allocations = 0;
+    reuses = 0;
+    heap_frees = 0;
+    cached_bytes = 0;
+}
+
+void buffer_pool_stats_t::add(buffer_pool_stats_t const & stats)
+{
+    requests += stats.requests;
+    heap_allocations += stats.heap_allocations;
+    reuses += stats.reuses;
+    heap_frees += stats.heap_frees;
+    cached_bytes += stats.cached_bytes;
+}
+
+std::mutex buffer_pool_t::_retired_lock;
+buffer_pool_stats_t buffer_pool_t::_retired;
+std::atomic<uint64_t> buffer_pool_t::_all_cached_bytes(0);
+
+void buffer_pool_t::retire()
+{
+    std::lock_guard<std::mutex> lock(_retired_lock);
+
+    /* The cache goes away with the thread */
+    instance()._stats.cached_bytes = 0;
+    _retired.add(instance()._stats);
+    instance()._stats = buffer_pool_stats_t();
+}
+
+buffer_pool_stats_t buffer_pool_t::totals()
+{
+    std::lock_guard<std::mutex> lock(_retired_lock);
+    buffer_pool_stats_t totals = _retired;
+
+    totals.add(instance().stats());
+    return totals;
+}
+
+buffer_pool_t::buffer_pool_t()
+{
+    _cached_bytes = 0;
+}
+
+buffer_pool_t::~buffer_pool_t()
+{
+    uint32_t size_class;
+
+    _all_cached_bytes -= _cached_bytes;
+
+    for (size_class = 0; size_class < classes_count; ++size_class)
+    {
+        for (std::vector<void *>::iterator it = _free[size_class].begin(); it != _free[size_class].end(); ++it)
+        {
+            operator delete(*it);
+        }
+    }
+}
+
+/* Sizes above 2^shift, up to 2^(shift + 1), are in class_steps classes */
+uint32_t buffer_pool_t::size_class(uint32_t size)
+{
+    uint32_t shift;
+
+    if (size <= (1U << min_class_shift))
+    {
+        return 0;
+    }
+
+    shift = 31 - __builtin_clz(size - 1);
+    return (shift - min_class_shift) * class_steps + ((size - 1 - (1U << shift)) >> (shift - 2)) + 1;
+}
+
+uint64_t buffer_pool_t::class_size(uint32_t size_class)
+{
+    uint32_t shift = min_class_shift + size_class / class_steps;
+
+    return ((uint64_t)1 << shift) + ((uint64_t)(size_class % class_steps) << (shift - 2));
+}
+
+buffer_pool_t & buffer_pool_t::instance()
+{
+    /* One pool per thread, no locking needed */
+    static thread_local buffer_pool_t pool;
+
+    return pool;
+}
+
+void * buffer_pool_t::acquire(uint32_t size)
+{
+    uint32_t size_class;
+    void * buffer;
+
+    ++_stats.requests;
+
+    size_class = buffer_pool_t::size_class(size);
+    if (!_free[size_class].empty())
+    {
+        buffer = _free[size_class].back();
+        _free[size_class].pop_back();
+        _stats.cached_bytes -= class_size(size_class);
+        _cached_bytes -= class_size(size_class);
+        _all_cached_bytes -= class_size(size_class);
+        ++_stats.reuses;
+        return buffer;
+    }
+
+    /* Always allocate the whole class, so that the buffer can serve any later request of that class */
+    buffer = operator new(class_size(size_class), std::nothrow);
+    if (buffer != 0)
+    {
+        ++_stats.heap_allocations;
+    }
+
+    return buffer;
+}
+
+void buffer_pool_t::release(void * buffer, uint32_t size)
+{
+    uint32_t size_class;
+    uint64_t buffer_size;
+
+    if (buffer == 0)
+    {
+        return;
+    }
+
+    size_class = buffer_pool_t::size_class(size);
+    buffer_size = class_size(size_class);
+    if (_all_cached_bytes.fetch_add(buffer_size) + buffer_size > max_cached_bytes)
+    {
+        _all_cached_bytes -= buffer_size;
+        ++_stats.heap_frees;
+        operator delete(buffer);
+        return;
+    }
+
+    _free[size_class].push_back(buffer);
+    _stats.cached_bytes += buffer_size;
+    _cached_bytes += buffer_size;
+}
+
+histogram_t::histogram_t()
+{
+    _count = 0;
+    _sum = 0;
+    _min = 0;
+    _max = 0;
+    std::fill(_buckets, _buckets + buckets_count, 0);
+}
+
+void histogram_t::add(uint32_t value)
+{
+    uint32_t bucket = (value == 0 ? 0 : 32 - __builtin_clz(value));
+
+    _min = (_count == 0 ? value : std::min(_min, value));
+    _max = std::max(_max, value);
+    ++_count;
+    _sum += value;
+    ++_buckets[bucket];
+}
+
+/* min/mean/max, then the non empty buckets as low-high:count */
+void histogram_t::print(std::ostream & out) const
+{
+    uint32_t bucket;
+
+    if (_count == 0)
+    {
+        out << "none" << std::endl;
+        return;
+    }
+
+    print_format(out, "min %u, mean %.1f, max %u |", _min, (double)_sum / _count, _max);
+    for (bucket = 0; bucket < buckets_count; ++bucket)
+    {
+        uint64_t low = (bucket == 0 ? 0 : (uint64_t)1 << (bucket - 1));
+        uint64_t high = (bucket == 0 ? 0 : ((uint64_t)1 << bucket) - 1);
+
+        if (_buckets[bucket] == 0)
+        {
+            continue;
+        }
+
+        if (low == high)
+        {
+            print_format(out, " %" PRIu64 ":%" PRIu64, low, _buckets[bucket]);
+        }
+        else
+        {
+            print_format(out, " %" PRIu64 "-%" PRIu64 ":%" PRIu64, low, high, _buckets[bucket]);
+        }
+    }
+    out << std::endl;
+}
+
+name_table_t::~name_table_t()
+{
+    for (std::vector<std::pair<void *, uint32_t> >::iterator it = _buffers.begin(); it != _buffers.end(); ++it)
+    {
+        buffer_pool_t::instance().release(it->first, it->second);
+    }
+}
+
+void name_table_t::adopt(void * buffer, uint32_t size)
+{
+    /* Names point into it, keep it until the table goes away */
+    _buffers.push_back(std::make_pair(buffer, size));
+}
+
+uint64_t name_table_t::buffers_size() const
+{
+    uint64_t size = 0;
+
+    for (std::vector<std::pair<void *, uint32_t> >::const_iterator it = _buffers.begin(); it != _buffers.end(); ++it)
+    {
+        size += it->second;
+    }
+
+    return size;
+}
+
+uint64_t name_table_t::memory_size() const
+{
+    /* Nodes of the interning map hold a key, an id and a link */
+    return _names.capacity() * sizeof(std::string_view) + _ids.bucket_count() * sizeof(void *) +
+           _ids.size() * (sizeof(std::pair<std::string_view, uint32_t>) + sizeof(void *)) +
+           _buffers.capacity() * sizeof(std::pair<void *, uint32_t>);
+}
+
+uint32_t name_table_t::intern(char const * name, uint32_t length)
+{
+    std::string_view view(name, length);
+    std::pair<std::unordered_map<std::string_view, uint32_t>::iterator, bool> inserted;
+
+    inserted = _ids.insert(std::make_pair(view, (uint32_t)_names.size()));
+    if (inserted.second)
+    {
+        _names.push_back(view);
+    }
+
+    return inserted.first->second;
+}
+
+void symbol_store_t::push_back(uint32_t offset, uint32_t length, uint16_t kind, uint16_t segment, uint32_t name_id, uint32_t type_index)
+{
+    _offsets.push_back(offset);
+    _lengths.push_back(length);
+    _kinds.push_back(kind);
+    _segments.push_back(segment);
+    _name_ids.push_back(name_id);
+    _type_indexes.push_back(type_index);
+}
+
+void symbol_store_t::clear()
+{
+    _offsets.clear();
+    _lengths.clear();
+    _kinds.clear();
+    _segments.clear();
+    _name_ids.clear();
+    _type_indexes.clear();
+}
+
+compressed_u64_array_t::compressed_u64_array_t()
+{
+    _size = 0;
+    _pending_count = 0;
+}
+
+void compressed_u64_array_t::clear()
+{
+    _size = 0;
+    _pending_count = 0;
+    _bases.clear();
+    _starts.clear();
+    _widths.clear();
+    _words.clear();
+}
+
+uint64_t compressed_u64_array_t::memory_size() const
+{
+    return _bases.capacity() * sizeof(uint64_t) + _starts.capacity() * sizeof(uint32_t) +
+           _widths.capacity() * sizeof(uint8_t) + _words.capacity() * sizeof(uint32_t);
+}
+
+void compressed_u64_array_t::push_back(uint64_t value)
+{
+    _pending[_pending_count++] = value;
+    ++_size;
+
+    if (_pending_count == block_size)
+    {
+        pack_block();
+    }
+}
+
+void compressed_u64_array_t::finish()
+{
+    if (_pending_count != 0)
+    {
+        pack_block();
+    }
+
+    _bases.shrink_to_fit();
+    _starts.shrink_to_fit();
+    _widths.shrink_to_fit();
+    _words.shrink_to_fit();
+}
+
+void compressed_u64_array_t::pack_block()
+{
+    uint64_t base = _pending[0];
+    uint64_t range = _pending[_pending_count - 1] - base;
+    uint32_t start = _words.size();
+    uint8_t width = 0;
+    uint32_t value;
+
+    while (width < 32 && (range >> width) != 0)
+    {
+        ++width;
+    }
+
+    if ((range >> width) != 0)
+    {
+        width = raw_width;
+    }
+
+    _bases.push_back(base);
+    _starts.push_back(start);
+    _widths.push_back(width);
+
+    if (width == raw_width)
+    {
+        _words.resize(start + _pending_count * 2);
+        memcpy(&_words[start], _pending, _pending_count * sizeof(uint64_t));
+        _pending_count = 0;
+        return;
+    }
+
+    /* Value i goes in lane i % 4, as the (i / 4)th width bits field of that lane */
+    _words.resize(start + width * lanes, 0);
+    for (value = 0; value < _pending_count; ++value)
+    {
+        uint32_t delta = _pending[value] - base;
+        uint32_t bit = (value / lanes) * width;
+        uint32_t word = start + (bit / 32) * lanes + value % lanes;
+
+        _words[word] |= delta << (bit % 32);
+        if (bit % 32 + width > 32)
+        {
+            _words[word + lanes] |= delta >> (32 - bit % 32);
+        }
+    }
+
+    _pending_count = 0;
+}
+
+void compressed_u64_array_t::unpack_block(uint32_t block, uint64_t * values) const
+{
+    uint32_t const * words = &_words[0] + _starts[block];
+    uint8_t width = _widths[block];
+    uint64_t base = _bases[block];
+    uint32_t deltas[block_size];
+    uint32_t row;
+    uint32_t value;
+
+    if (width == raw_width)
+    {
+        memcpy(values, words, min(block_size, _size - (uint64_t)block * block_size) * sizeof(uint64_t));
+        return;
+    }
+
+    if (width == 0)
+    {
+        memset(deltas, 0, sizeof(deltas));
+    }
+    else
+    {
+        /* Each row unpacks the same field of the four lanes, i.e. four consecutive values */
+#if defined(__SSE2__)
+        __m128i const mask = _mm_set1_epi32(width == 32 ? 0xFFFFFFFF : (1U << width) - 1);
+#endif
+
+        for (row = 0; row < block_size / lanes; ++row)
+        {
+            uint32_t bit = row * width;
+            uint32_t const * low = words + (bit / 32) * lanes;
+            uint32_t shift = bit % 32;
+
+#if defined(__SSE2__)
+            __m128i packed = _mm_srl_epi32(_mm_loadu_si128((__m128i const *)low), _mm_cvtsi32_si128(shift));
+            if (shift + width > 32)
+            {
+                packed = _mm_or_si128(packed, _mm_sll_epi32(_mm_loadu_si128((__m128i const *)(low + lanes)), _mm_cvtsi32_si128(32 - shift)));
+            }
+            _mm_storeu_si128((__m128i *)(deltas + row * lanes), _mm_and_si128(packed, mask));
+#else
+            uint32_t const mask = (width == 32 ? 0xFFFFFFFF : (1U << width) - 1);
+            uint32_t lane;
+
+            for (lane = 0; lane < lanes; ++lane)
+            {
+                uint32_t packed = low[lane] >> shift;
+                if (shift + width > 32)
+                {
+                    packed |= low[lane + lanes] << (32 - shift);
+                }
+                deltas[row * lanes + lane] = packed & mask;
+            }
+#endif
+        }
+    }
+
+    for (value = 0; value < block_size; ++value)
+    {
+        values[value] = base + deltas[value];
+    }
+}
+
+bool compressed_u64_array_t::find_last_not_greater(uint64_t value, uint64_t * position, uint64_t * found) const
+{
+    std::vector<uint64_t>::const_iterator it;
+    uint64_t values[block_size];
+    uint32_t block;
+    uint32_t count;
+    uint64_t * last;
+
+    /* Skip entries first, then only the block that can hold the value */
+    it = std::upper_bound(_bases.begin(), _bases.end(), value);
+    if (it == _bases.begin())
+    {
+        return false;
+    }
+
+    block = it - 1 - _bases.begin();
+    count = min(block_size, _size - (uint64_t)block * block_size);
+    unpack_block(block, values);
+
+    last = std::upper_bound(values, values + count, value) - 1;
+    *position = (uint64_t)block * block_size + (last - values);
+    *found = *last;
+    return true;
+}
+
+void name_dictionary_t::write_length(std::vector<char> & data, uint32_t length)
+{
+    while (length >= 0x80)
+    {
+        data.push_back((char)(length | 0x80));
+        length >>= 7;
+    }
+
+    data.push_back((char)length);
+}
+
+uint32_t name_dictionary_t::read_length(char const * & data)
+{
+    uint32_t length = 0;
+    uint32_t shift = 0;
+
+    while ((uint8_t)*data & 0x80)
+    {
+        length |= (uint32_t)((uint8_t)*data++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    return length | ((uint32_t)(uint8_t)*data++ << shift);
+}
+
+void name_dictionary_t::build(name_table_t const & names)
+{
+    std::string_view previous;
+    uint32_t name;
+
+    _data.clear();
+    _buckets.clear();
+    _ids.resize(names.size());
+    for (name = 0; name < names.size(); ++name)
+    {
+        _ids[name] = name;
+    }
+
+    std::sort(_ids.begin(), _ids.end(), [&names](uint32_t a, uint32_t b) { return names.name(a) < names.name(b); });
+
+    for (name = 0; name < _ids.size(); ++name)
+    {
+        std::string_view current = names.name(_ids[name]);
+        uint32_t shared = 0;
+
+        if (name % bucket_size == 0)
+        {
+            _buckets.push_back(_data.size());
+        }
+        else
+        {
+            while (shared < current.size() && shared < previous.size() && current[shared] == previous[shared])
+            {
+                ++shared;
+            }
+
+            write_length(_data, shared);
+        }
+
+        write_length(_data, current.size() - shared);
+        _data.insert(_data.end(), current.begin() + shared, current.end());
+        previous = current;
+    }
+
+    _data.shrink_to_fit();
+    _buckets.shrink_to_fit();
+}
+
+uint64_t name_dictionary_t::memory_size() const
+{
+    return _data.capacity() + _buckets.capacity() * sizeof(uint32_t) + _ids.capacity() * sizeof(uint32_t);
+}
+
+std::string_view name_dictionary_t::bucket_head(uint32_t bucket) const
+{
+    char const * data = &_data[0] + _buckets[bucket];
+    uint32_t length = read_length(data);
+
+    return std::string_view(data, length);
+}
+
+char const * name_dictionary_t::next_name(char const * data, std::string & name) const
+{
+    uint32_t shared = read_length(data);
+    uint32_t length = read_length(data);
+
+    name.resize(shared);
+    name.append(data, length);
+
+    return data + length;
+}
+
+uint32_t name_dictionary_t::lower_bound(std::string_view name) const
+{
+    std::string current;
+    char const * data;
+    uint32_t first = 0;
+    uint32_t count = _buckets.size();
+    uint32_t position;
+
+    /* Last bucket whose head is lower than the name */
+    while (count > 0)
+    {
+        uint32_t step = count / 2;
+
+        if (bucket_head(first + step) < name)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    if (first == 0)
+    {
+        return 0;
+    }
+
+    /* Then, walk that bucket */
+    position = (first - 1) * bucket_size;
+    current = bucket_head(first - 1);
+    data = &_data[0] + _buckets[first - 1];
+    data += read_length(data);
+    while (current < name)
+    {
+        ++position;
+        if (position % bucket_size == 0 || position == _ids.size())
+        {
+            break;
+        }
+
+        data = next_name(data, current);
+    }
+
+    return position;
+}
+
+void name_dictionary_t::enumerate_prefix(std::string_view prefix, std::vector<uint32_t> & ids) const
+{
+    std::string current;
+    char const * data;
+    uint32_t position;
+
+    position = lower_bound(prefix);
+    if (position == _ids.size())
+    {
+        return;
+    }
+
+    /* Rebuild the name at that position from its bucket head */
+    data = &_data[0] + _buckets[position / bucket_size];
+    for (uint32_t skipped = position - position % bucket_size; ; ++skipped)
+    {
+        if (skipped % bucket_size == 0)
+        {
+            uint32_t length = read_length(data);
+
+            current.assign(data, length);
+            data += length;
+        }
+        else
+        {
+            data = next_name(data, current);
+        }
+
+        if (skipped == position)
+        {
+            break;
+        }
+    }
+
+    while (current.compare(0, prefix.size(), prefix) == 0)
+    {
+        ids.push_back(_ids[position]);
+
+        ++position;
+        if (position == _ids.size())
+        {
+            break;
+        }
+
+        if (position % bucket_size == 0)
+        {
+            uint32_t length = read_length(data);
+
+            current.assign(data, length);
+            data += length;
+        }
+        else
+        {
+            data = next_name(data, current);
+        }
+    }
+}
+
+/* Symbols at the same address stay in symbol order, whatever the runs */
+static inline bool index_entry_less(index_entry_t const & a, index_entry_t const & b)
+{
+    return a.key < b.key || (a.key == b.key && a.symbol < b.symbol);
+}
+
+struct run_head_greater_t
+{
+    bool operator()(std::pair<index_entry_t, uint32_t> const & a, std::pair<index_entry_t, uint32_t> const & b) const
+    {
+        return index_entry_less(b.first, a.first);
+    }
+};
+
+address_index_t::address_index_t()
+{
+    _spilled_runs = 0;
+    _compressed = false;
+}
+
+uint64_t address_index_t::memory_size() const
+{
+    return _keys.capacity() * sizeof(uint64_t) + _packed_keys.memory_size() + _symbols.capacity() * sizeof(uint32_t);
+}
+
+void address_index_t::append(index_entry_t const & entry)
+{
+    if (_compressed)
+    {
+        _packed_keys.push_back(entry.key);
+    }
+    else
+    {
+        _keys.push_back(entry.key);
+    }
+    _symbols.push_back(entry.symbol);
+}
+
+int address_index_t::spill_run(std::vector<index_entry_t> & run, std::vector<FILE *> & runs)
+{
+    FILE * run_file;
+
+    std::sort(run.begin(), run.end(), index_entry_less);
+
+    run_file = tmpfile();
+    if (run_file == 0)
+    {
+        _error = "Failed to create temporary file for index run. Error: " + std::to_string(errno);
+        return -1;
+    }
+
+    runs.push_back(run_file);
+    if (fwrite(&run[0], sizeof(index_entry_t), run.size(), run_file) != run.size() || fflush(run_file) != 0)
+    {
+        _error = "Failed to write index run to temporary file. Error: " + std::to_string(errno);
+        return -1;
+    }
+
+    ++_spilled_runs;
+    run.clear();
+
+    return 0;
+}
+
+int address_index_t::merge_runs(std::vector<FILE *> const & runs, uint64_t memory_budget, FILE * output)
+{
+    typedef std::pair<index_entry_t, uint32_t> head_t;
+    std::priority_queue<head_t, std::vector<head_t>, run_head_greater_t> heads;
+    std::vector<std::vector<index_entry_t> > buffers(runs.size());
+    std::vector<size_t> positions(runs.size(), 0);
+    size_t chunk;
+    uint32_t run;
+
+    /* Each run gets an equal share of the budget for its read buffer */
+    chunk = memory_budget / runs.size() / sizeof(index_entry_t);
+    if (chunk == 0)
+    {
+        chunk = 1;
+    }
+
+    for (run = 0; run < runs.size(); ++run)
+    {
+        rewind(runs[run]);
+        buffers[run].resize(chunk);
+        buffers[run].resize(fread(&buffers[run][0], sizeof(index_entry_t), chunk, runs[run]));
+        if (!buffers[run].empty())
+        {
+            heads.push(head_t(buffers[run][0], run));
+        }
+    }
+
+    while (!heads.empty())
+    {
+        run = heads.top().second;
+        heads.pop();
+
+        if (output == 0)
+        {
+            append(buffers[run][positions[run]]);
+        }
+        else if (fwrite(&buffers[run][positions[run]], sizeof(index_entry_t), 1, output) != 1)
+        {
+            _error = "Failed to write index run to temporary file. Error: " + std::to_string(errno);
+            return -1;
+        }
+
+        if (++positions[run] == buffers[run].size())
+        {
+            buffers[run].resize(chunk);
+            buffers[run].resize(fread(&buffers[run][0], sizeof(index_entry_t), chunk, runs[run]));
+            positions[run] = 0;
+            if (buffers[run].empty())
+            {
+                if (ferror(runs[run]))
+                {
+                    _error = "Failed to read index run from temporary file. Error: " + std::to_string(errno);
+                    return -1;
+                }
+
+                continue;
+            }
+        }
+
+        heads.push(head_t(buffers[run][positions[run]], run));
+    }
+
+    return 0;
+}
+
+int address_index_t::build(symbol_store_t const & symbols, uint64_t memory_budget, bool compress)
+{
+    std::vector<index_entry_t> run;
+    std::vector<FILE *> runs;
+    uint64_t run_capacity;
+    uint64_t index_size;
+    uint32_t symbol;
+    int ret = 0;
+
+    _compressed = compress;
+    _error.clear();
+    _keys.clear();
+    _packed_keys.clear();
+    _symbols.clear();
+
+    /* The index itself comes out of the budget, what is left is for sorting.
+     * Compressed keys are only known once packed, they are checked last */
+    index_size = (uint64_t)symbols.size() * sizeof(uint32_t);
+    if (!_compressed)
+    {
+        index_size += (uint64_t)symbols.size() * sizeof(uint64_t);
+    }
+
+    if (memory_budget != 0)
+    {
+        if (index_size >= memory_budget)
+        {
+            _error = "Memory budget of " + std::to_string(memory_budget) + " bytes cannot hold the index of " + std::to_string(index_size) + " bytes";
+            return -1;
+        }
+
+        memory_budget -= index_size;
+    }
+
+    run_capacity = symbols.size();
+    if (memory_budget != 0 && memory_budget / sizeof(index_entry_t) < run_capacity)
+    {
+        run_capacity = memory_budget / sizeof(index_entry_t);
+        if (run_capacity == 0)
+        {
+            run_capacity = 1;
+        }
+    }
+
+    run.reserve(run_capacity);
+    for (symbol = 0; symbol < symbols.size(); ++symbol)
+    {
+        index_entry_t entry;
+
+        entry.key = make_key(symbols.segment(symbol), symbols.offset(symbol));
+        entry.symbol = symbol;
+        run.push_back(entry);
+
+        if (run.size() == run_capacity && symbol + 1 < symbols.size())
+        {
+            if (spill_run(run, runs) == -1)
+            {
+                ret = -1;
+                goto leave;
+            }
+        }
+    }
+
+    if (runs.empty())
+    {
+        std::sort(run.begin(), run.end(), index_entry_less);
+        if (!_compressed)
+        {
+            _keys.reserve(run.size());
+        }
+        _symbols.reserve(run.size());
+        for (std::vector<index_entry_t>::const_iterator it = run.begin(); it != run.end(); ++it)
+        {
+            append(*it);
+        }
+
+        goto leave;
+    }
+
+    /* Spill the last run as well, so that the whole budget is available for the merge */
+    if (!run.empty() && spill_run(run, runs) == -1)
+    {
+        ret = -1;
+        goto leave;
+    }
+
+    std::vector<index_entry_t>().swap(run);
+
+    /* Too many runs, merge them by groups into bigger runs first */
+    while (runs.size() > max_merged_runs)
+    {
+        std::vector<FILE *> group(runs.begin(), runs.begin() + max_merged_runs);
+        FILE * merged;
+
+        merged = tmpfile();
+        if (merged == 0)
+        {
+            _error = "Failed to create temporary file for index run. Error: " + std::to_string(errno);
+            ret = -1;
+            goto leave;
+        }
+
+        runs.erase(runs.begin(), runs.begin() + max_merged_runs);
+        runs.push_back(merged);
+        ret = merge_runs(group, memory_budget, merged);
+        for (std::vector<FILE *>::iterator it = group.begin(); it != group.end(); ++it)
+        {
+            fclose(*it);
+        }
+
+        if (ret == -1 || fflush(merged) != 0)
+        {
+            if (ret != -1)
+            {
+                _error = "Failed to write index run to temporary file. Error: " + std::to_string(errno);
+            }
+
+            ret = -1;
+            goto leave;
+        }
+    }
+
+    if (!_compressed)
+    {
+        _keys.reserve(symbols.size());
+    }
+    _symbols.reserve(symbols.size());
+    ret = merge_runs(runs, memory_budget, 0);
+
+leave:
+    _packed_keys.finish();
+
+    if (ret == 0 && memory_budget != 0 && memory_size() > memory_budget + index_size)
+    {
+        _error = "Memory budget of " + std::to_string(memory_budget + index_size) + " bytes cannot hold the index of " + std::to_string(memory_size()) + " bytes";
+        ret = -1;
+    }
+
+    for (std::vector<FILE *>::iterator it = runs.begin(); it != runs.end(); ++it)
+    {
+        fclose(*it);
+    }
+
+    return ret;
+}
+
+bool address_index_t::find(uint16_t segment, uint32_t offset, uint32_t * symbol) const
+{
+    std::vector<uint64_t>::const_iterator it;
+    uint64_t position;
+    uint64_t key;
+
+    /* Last symbol starting at or before the address, in the same segment */
+    if (_compressed)
+    {
+        if (!_packed_keys.find_last_not_greater(make_key(segment, offset), &position, &key))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        it = std::upper_bound(_keys.begin(), _keys.end(), make_key(segment, offset));
+        if (it == _keys.begin())
+        {
+            return false;
+        }
+
+        position = it - 1 - _keys.begin();
+        key = *(it - 1);
+    }
+
+    if ((key >> 32) != segment)
+    {
+        return false;
+    }
+
+    *symbol = _symbols[position];
+    return true;
+}
+
+io_stats_t::io_stats_t()
+{
+    syscalls = 0;
+    seeks = 0;
+    bytes_read = 0;
+    bytes_copied = 0;
+    pages = 0;
+    cached_pages = 0;
+    next_offset = (uint64_t)-1;
+}
+
+void io_stats_t::add(io_stats_t const & stats)
+{
+    syscalls += stats.syscalls;
+    seeks += stats.seeks;
+    bytes_read += stats.bytes_read;
+    bytes_copied += stats.bytes_copied;
+    pages += stats.pages;
+    cached_pages += stats.cached_pages;
+}
+
+std::mutex pdb_io_t::_totals_lock;
+io_stats_t pdb_io_t::_directory_totals;
+io_stats_t pdb_io_t::_totals[stream_kinds_count];
+
+void pdb_io_t::add_totals(io_stats_t const & directory, io_stats_t const * const kinds)
+{
+    std::lock_guard<std::mutex> lock(_totals_lock);
+    uint32_t kind;
+
+    _directory_totals.add(directory);
+    for (kind = 0; kind < stream_kinds_count; ++kind)
+    {
+        _totals[kind].add(kinds[kind]);
+    }
+}
+
+void pdb_io_t::totals(io_stats_t * directory, io_stats_t * kinds)
+{
+    std::lock_guard<std::mutex> lock(_totals_lock);
+
+    *directory = _directory_totals;
+    std::copy(_totals, _totals + stream_kinds_count, kinds);
+}
+
+pdb_io_t::pdb_io_t()
+{
+    _backend = io_backend_stdio;
+    _stream = 0;
+    _fd = -1;
+    _mapping = MAP_FAILED;
+    _mapping_size = 0;
+}
+
+pdb_io_t::~pdb_io_t()
+{
+    close();
+}
+
+int pdb_io_t::open(char const * const file, io_backend_t backend)
+{
+    struct stat buf;
+
+    _backend = backend;
+    if (_backend == io_backend_stdio)
+    {
+        _stream = fopen(file, "rb");
+        if (_stream == 0)
+        {
+            return -1;
+        }
+
+        _fd = fileno(_stream);
+        return 0;
+    }
+
+    _fd = ::open(file, O_RDONLY);
+    if (_fd == -1)
+    {
+        return -1;
+    }
+
+    if (_backend == io_backend_mmap)
+    {
+        if (fstat(_fd, &buf) == -1)
+        {
+            return -1;
+        }
+
+        /* Empty files can't be mapped, reads will fail */
+        _mapping_size = buf.st_size;
+        if (_mapping_size != 0)
+        {
+            _mapping = mmap(0, _mapping_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (_mapping == MAP_FAILED)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void pdb_io_t::close()
+{
+    if (_mapping != MAP_FAILED)
+    {
+        munmap(_mapping, _mapping_size);
+        _mapping = MAP_FAILED;
+    }
+
+    if (_stream != 0)
+    {
+        fclose(_stream);
+        _stream = 0;
+    }
+    else if (_fd != -1)
+    {
+        ::close(_fd);
+    }
+
+    _fd = -1;
+}
+
+int pdb_io_t::size(uint64_t * size) const
+{
+    struct stat buf;
+
+    if (fstat(_fd, &buf) == -1)
+    {
+        return -1;
+    }
+
+    *size = buf.st_size;
+    return 0;
+}
+
+void pdb_io_t::count_cached_pages(uint64_t offset, uint32_t size, io_stats_t * stats) const
+{
+    static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> residency;
+    uint64_t start;
+    uint64_t page;
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    /* Mappings start on a page boundary */
+    start = offset & ~(page_size - 1);
+    residency.resize((offset + size - start + page_size - 1) / page_size);
+    if (mincore((char *)_mapping + start, offset + size - start, &residency[0]) == -1)
+    {
+        return;
+    }
+
+    stats->pages += residency.size();
+    for (page = 0; page < residency.size(); ++page)
+    {
+        stats->cached_pages += (residency[page] & 1);
+    }
+}
+
+int pdb_io_t::read_at(void * buffer, uint64_t offset, uint32_t size, io_stats_t * stats)
+{
+    if (stats != 0)
+    {
+        if (offset != stats->next_offset)
+        {
+            ++stats->seeks;
+        }
+
+        stats->next_offset = offset + size;
+    }
+
+    switch (_backend)
+    {
+        case io_backend_stdio:
+            if (stats != 0)
+            {
+                ++stats->syscalls;
+                stats->bytes_read += size;
+            }
+
+            if (fseeko(_stream, offset, SEEK_SET) == -1 || fread(buffer, size, 1, _stream) != 1)
+            {
+                return -1;
+            }
+            break;
+
+        case io_backend_pread:
+            while (size != 0)
+            {
+                ssize_t ret = pread(_fd, buffer, size, offset);
+
+                if (stats != 0)
+                {
+                    ++stats->syscalls;
+                    stats->bytes_read += (ret > 0 ? ret : 0);
+                }
+
+                if (ret == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (ret <= 0)
+                {
+                    return -1;
+                }
+
+                buffer = (void *)((char *)buffer + ret);
+                offset += ret;
+                size -= ret;
+            }
+            break;
+
+        case io_backend_mmap:
+            if (offset > _mapping_size || size > _mapping_size - offset)
+            {
+                return -1;
+            }
+
+            if (stats != 0)
+            {
+                /* Before the copy faults them in */
+                count_cached_pages(offset, size, stats);
+                stats->bytes_copied += size;
+            }
+
+            memcpy(buffer, (char *)_mapping + offset, size);
+            break;
+
+        default:
+            return -1;
+    }
+
+    return 0;
+}
+
+pdb_file_t::pdb_file_t(char const * const pdb_file, pdb_options_t const & options, std::ostream & out, std::ostream & err) : _options(options), _out(out), _err(err)
+{
+    _pdb_file = pdb_file;
+    _root_stream = 0;
+    _pdb_version = pdb_version_2;
+    _format = pdb_format_2;
+    _decoders = &_format_decoders[_format];
+    _gs_stream = -1;
+    _ps_stream = -1;
+    _sym_stream = -1;
+    _address_index_built = false;
+    _dictionary_built = false;
+}
+
+pdb_file_t::~pdb_file_t()
+{
+    if (_options.stats)
+    {
+        io_stats_t kinds[stream_kinds_count];
+        uint32_t entry;
+
+        for (entry = 0; entry < _streams_io.size(); ++entry)
+        {
+            kinds[stream_kind(entry)].add(_streams_io[entry]);
+        }
+
+        phase_scope_t::add_totals(_phases);
+        pdb_io_t::add_totals(_directory_io, kinds);
+    }
+
+    if (_options.stats_files)
+    {
+        _err << "Phases of '" << _pdb_file << "':" << std::endl;
+        print_phases(_err, _phases);
+        print_io();
+    }
+
+    if (_root_stream != 0)
+    {
+        buffer_pool_t::instance().release(_root_stream, _header.root_stream.stream_size);
+        _root_stream = 0;
+    }
+}
+
+int pdb_file_t::validate_header()
+{
+    uint64_t file_size;
+    char buffer[PDB_SIGNATURE_200_SIZE + 1];
+
+    /* Get file size */
+    if (_io.size(&file_size) == -1)
+    {
+        _err << "Failed to read attributes of '" << _pdb_file << "'. Error: " << errno << std::endl;
+        return -1;
+    }
+
+    /* Check Signature */
+    if (_io.read_at(buffer, 0, PDB_SIGNATURE_200_SIZE, directory_io()) == -1)
+    {
+        _err << "Failed to read PDB signature of '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    buffer[PDB_SIGNATURE_200_SIZE] = 0;
+    if (strncmp(buffer, PDB_SIGNATURE_200, PDB_SIGNATURE_200_SIZE) != 0)
+    {
+        _err << "Invalid PDB signature in '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    /* Read header */
+    if (_io.read_at(&_header, PDB_SIGNATURE_200_SIZE, sizeof(pdb_header_t), directory_io()) == -1)
+    {
+        _err << "Failed to read PDB header of '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    /* Validate header */
+    if (_header.page_size != 0x400 && _header.page_size != 0x800 && _header.page_size != 0x1000)
+    {
+        _err << "Invalid page size in PDB header of '" << _pdb_file << "': " << _header.page_size << std::endl;
+        return -1;
+    }
+    if (_header.start_page != 0x9 && _header.start_page != 0x5 && _header.start_page != 0x2)
+    {
+        _err << "Invalid start page in PDB header of '" << _pdb_file << "': " << _header.start_page << std::endl;
+        return -1;
+    }
+    if ((uint16_t)(file_size / _header.page_size) != _header.file_pages)
+    {
+        _err << "Invalid number of pages in PDB header of '" << _pdb_file << "'. Got: " << _header.file_pages << ", expected: " << (uint16_t)(file_size / _header.page_size) << std::endl;
+        return -1;
+    }
+    if (_header.root_stream.stream_size == -1)
+    {
+        _err << "Root stream marked free in '" << _pdb_file << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+int pdb_file_t::read_pages(void * buffer, uint32_t size, uint32_t pages, uint16_t const * const pages_list, char const * const what, std::ostream & err, io_stats_t * stats)
+{
+    uint32_t page;
+    uint32_t run;
+
+    /* Runs of contiguous pages are read at once */
+    for (page = 0; page < pages && size != 0; page = run)
+    {
+        uint64_t page_position;
+        uint32_t to_read;
+
+        for (run = page; run < pages; ++run)
+        {
+            if (pages_list[run] > _header.file_pages)
+            {
+                err << "Page " << run << " of " << what << " stream from '" << _pdb_file << "' beyond maximum page" << std::endl;
+                return -1;
+            }
+
+            if (run != page && pages_list[run] != pages_list[run - 1] + 1)
+            {
+                break;
+            }
+        }
+
+        page_position = (uint64_t)pages_list[page] * _header.page_size;
+        to_read = min((run - page) * _header.page_size, size);
+        if (_io.read_at((void *)((char *)buffer + (page * _header.page_size)), page_position, to_read, stats) == -1)
+        {
+            err << "Failed to read " << what << " stream page " << page << " at " << page_position << " from '" << _pdb_file << "'" << std::endl;
+            return -1;
+        }
+
+        size -= to_read;
+    }
+
+    if (size != 0)
+    {
+        err << "Inconsistent " << what << " stream read in '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+int pdb_file_t::open_root_stream()
+{
+    uint32_t root_size;
+    uint32_t root_pages;
+    std::vector<uint16_t> root_pages_list;
+
+    /* Prepare and validate for root stream read */
+    root_size = _header.root_stream.stream_size;
+    root_pages = (root_size / _header.page_size) + 1;
+    if (root_size == 0 || root_pages == 0)
+    {
+        _err << "Invalid number of root pages in '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    _root_stream = static_cast<pdb_root_t *>(buffer_pool_t::instance().acquire(root_size));
+    if (_root_stream == 0)
+    {
+        _err << "Memory allocation failure for " << root_size << "B\n" << std::endl;
+        return -1;
+    }
+
+    /* Its pages list follows the header */
+    root_pages_list.resize(root_pages);
+    if (_io.read_at(&root_pages_list[0], PDB_SIGNATURE_200_SIZE + sizeof(pdb_header_t), root_pages * sizeof(uint16_t), directory_io()) == -1)
+    {
+        _err << "Failed to read root pages list from '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    /* Read the root stream */
+    if (read_pages(_root_stream, root_size, root_pages, &root_pages_list[0], "root", _err, directory_io()) == -1)
+    {
+        return -1;
+    }
+
+    /* Validate number of streams in root */
+    if (offsetof(pdb_root_t, streams) + _root_stream->count * sizeof(pdb_stream_t) > _header.root_stream.stream_size)
+    {
+        _err << "Inconsistent root stream size in '" << _pdb_file << "'\n" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+void pdb_file_t::read_stream_root_t(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    if (stream->stream_size != _header.root_stream.stream_size)
+    {
+        _err << "Mismatching root stream and copy root stream sizes in '" << _pdb_file << "'!" << std::endl;
+    }
+
+    return;
+}
+
+int pdb_file_t::parse_pdb_header(pdb_stream_t const * const stream, pdb_stream_header_ex_t const * const pdb_header)
+{
+    if (stream->stream_size < sizeof(pdb_stream_header_t))
+    {
+        _err << "PDB header stream too small to contain its header in '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    _pdb_version = pdb_header->header.version;
+    if (_pdb_version > pdb_version_7p)
+    {
+        _format = pdb_format_7;
+    }
+    else if (_pdb_version > pdb_version_4)
+    {
+        _format = pdb_format_5;
+    }
+    else
+    {
+        _format = pdb_format_2;
+    }
+
+    _decoders = &_format_decoders[_format];
+    return 0;
+}
+
+pdb_file_t::decoders_t const pdb_file_t::_format_decoders[pdb_formats_count] =
+{
+    { &pdb_file_t::parse_dbi<pdb_format_2>, &pdb_file_t::print_dbi_version<pdb_format_2>, &pdb_file_t::print_pdb_id<pdb_format_2> },
+    { &pdb_file_t::parse_dbi<pdb_format_5>, &pdb_file_t::print_dbi_version<pdb_format_5>, &pdb_file_t::print_pdb_id<pdb_format_5> },
+    { &pdb_file_t::parse_dbi<pdb_format_7>, &pdb_file_t::print_dbi_version<pdb_format_7>, &pdb_file_t::print_pdb_id<pdb_format_7> },
+};
+
+/* Older headers have no GUID */
+template <pdb_format_t format>
+void pdb_file_t::print_pdb_id(pdb_stream_t const * const stream, pdb_stream_header_ex_t const * const pdb_header)
+{
+    if constexpr (format == pdb_format_7)
+    {
+        if (stream->stream_size < sizeof(pdb_stream_header_ex_t))
+        {
+            _err << "PDB header stream too small to contain its extended header in '" << _pdb_file << "'" << std::endl;
+            return;
+        }
+
+        print_format(_out, "PDB ID: %08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%d\n", pdb_header->guid.data1, pdb_header->guid.data2,
+                                                                           pdb_header->guid.data3, pdb_header->guid.data4[0],
+                                                                           pdb_header->guid.data4[1], pdb_header->guid.data4[2],
+                                                                           pdb_header->guid.data4[3], pdb_header->guid.data4[4],
+                                                                           pdb_header->guid.data4[5], pdb_header->guid.data4[6],
+                                                                           pdb_header->guid.data4[7], pdb_header->header.age);
+    }
+}
+
+void pdb_file_t::read_stream_pdb_header_t(pdb_stream_t const * const stream, uint16_t stream_index, pdb_stream_header_ex_t const * const pdb_header)
+{
+    if (parse_pdb_header(stream, pdb_header) == -1)
+    {
+        return;
+    }
+
+    switch (pdb_header->header.version)
+    {
+        case pdb_version_2:
+            _out << "PDB file from VisualC++ 2.0" << std::endl;
+            break;
+
+        case pdb_version_4:
+        case pdb_version_41:
+            _out << "PDB file from VisualC++ 4.0" << std::endl;
+            break;
+
+        case pdb_version_5:
+            _out << "PDB file from VisualC++ 5.0" << std::endl;
+            break;
+
+        case pdb_version_6:
+            _out << "PDB file from VisualC++ 6.0" << std::endl;
+            break;
+
+        case pdb_version_7p:
+        case pdb_version_7:
+            _out << "PDB file from VisualC++ 7.0" << std::endl;
+            break;
+
+        default:
+            _out << "Unknown VisualC++ release: " << pdb_header->header.version << std::endl;
+            break;
+    }
+
+    (this->*_decoders->print_pdb_id)(stream, pdb_header);
+
+    return;
+}
+
+void pdb_file_t::read_stream_tpi(pdb_stream_t const * const stream, uint16_t stream_index, tpi_header_t const * const tpi_header)
+{
+    if (stream->stream_size < sizeof(tpi_header_t))
+    {
+        _err << "TPI stream too small to contain its header in '" << _pdb_file << "'" << std::endl;
+        return;
+    }
+
+    switch (tpi_header->version)
+    {
+        case tpi_version_6:
+            _out << "TPI stream from VisualC++ 6.0" << std::endl;
+            break;
+
+        default:
+            _out << "Unknown VisualC++ release: " << tpi_header->version << std::endl;
+            break;
+    }
+
+    if (tpi_header->size == 0)
+    {
+        if (tpi_header->min_ti != tpi_header->max_ti)
+        {
+            _out << "Corrupted header. No types information space whereas there are entries in '" << _pdb_file << "'" << std::endl;
+        }
+        else
+        {
+            _out << "No types information stored in '" << _pdb_file << "'" << std::endl;
+        }
+
+        return;
+    }
+
+    _out << "Min Type Info: " << tpi_header->min_ti << std::endl;
+    _out << "Max Type Info: " << tpi_header->max_ti << std::endl;
+
+    if (tpi_header->size + sizeof(tpi_header_t) > stream->stream_size)
+    {
+        _err << "TPI stream isn't big enough in '" << _pdb_file << "' to store types information" << std::endl;
+        return;
+    }
+
+    if (_options.histograms)
+    {
+        histogram_types(stream_index, tpi_header, stream->stream_size);
+    }
+
+    return;
+}
+
+/* Locates the symbol streams */
+template <pdb_format_t format>
+int pdb_file_t::parse_dbi(pdb_stream_t const * const stream, void const * const stream_buffer)
+{
+    if constexpr (format != pdb_format_2)
+    {
+        dbi_header_t const * const dbi_header = static_cast<dbi_header_t const *>(stream_buffer);
+
+        if (stream->stream_size < sizeof(dbi_header_t))
+        {
+            _err << "DBI stream too small to contain its header in '" << _pdb_file << "'" << std::endl;
+            return -1;
+        }
+
+        if (dbi_header->signature != 0xFFFFFFFF)
+        {
+            _err << "Invalid signature for DBI stream in '" << _pdb_file << "': " << dbi_header->signature << std::endl;
+            return -1;
+        }
+
+        _gs_stream = dbi_header->global_symbols_stream;
+        _ps_stream = dbi_header->private_symbols_stream;
+        _sym_stream = dbi_header->symbols_stream;
+    }
+    else
+    {
+        old_dbi_header_t const * const dbi_header = static_cast<old_dbi_header_t const *>(stream_buffer);
+
+        if (stream->stream_size < sizeof(old_dbi_header_t))
+        {
+            _err << "DBI stream too small to contain its header in '" << _pdb_file << "'" << std::endl;
+            return -1;
+        }
+
+        _gs_stream = dbi_header->global_symbols_stream;
+        _ps_stream = dbi_header->private_symbols_stream;
+        _sym_stream = dbi_header->symbols_stream;
+    }
+
+    return 0;
+}
+
+/* Older headers don't tell */
+template <pdb_format_t format>
+void pdb_file_t::print_dbi_version(void const * const stream_buffer)
+{
+    if constexpr (format != pdb_format_2)
+    {
+        dbi_header_t const * const dbi_header = static_cast<dbi_header_t const *>(stream_buffer);
+
+        switch (dbi_header->version)
+        {
+            case dbi_version_41:
+                _out << "DBI stream from VisualC++ 4.0" << std::endl;
+                break;
+
+            case dbi_version_5:
+                _out << "DBI stream from VisualC++ 5.0" << std::endl;
+                break;
+
+            case dbi_version_6:
+                _out << "DBI stream from VisualC++ 6.0" << std::endl;
+                break;
+
+            case dbi_version_7:
+                _out << "DBI stream from VisualC++ 7.0" << std::endl;
+                break;
+
+            default:
+                _out << "Unknown VisualC++ release: " << dbi_header->version << std::endl;
+                break;
+        }
+    }
+}
+
+void pdb_file_t::read_stream_dbi(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    if ((this->*_decoders->parse_dbi)(stream, stream_buffer) == -1)
+    {
+        return;
+    }
+
+    (this->*_decoders->print_dbi_version)(stream_buffer);
+
+    return;
+}
+
+void pdb_file_t::read_stream_fpo(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    _out << "Frame pointer omission stream found" << std::endl;
+    return;
+}
+
+void pdb_file_t::read_stream_gs(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    _out << "Global symbols stream found" << std::endl;
+    return;
+}
+
+void pdb_file_t::read_stream_ps(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    _out << "Private symbols stream found" << std::endl;
+    return;
+}
+
+/* Fills the file's tables */
+struct symbol_store_visitor_t
+{
+    name_table_t & names;
+    symbol_store_t & symbols;
+
+    void operator()(record_kind_t<symbol_data_version_2>, symbol_record_t const & record)
+    {
+        symbols.push_back(record.data->offset, record.length, record.data->version, record.data->segment,
+                          names.intern(record.name.data(), record.name.size()), record.data->type);
+    }
+};
+
+void pdb_file_t::read_stream_sym(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer)
+{
+    symbol_store_visitor_t visitor = { _names, _symbols };
+
+    _symbols.clear();
+
+    if (stream->stream_size < sizeof(uint16_t))
+    {
+        _err << "Symbol stream too small to contain its signature in '" << _pdb_file << "'" << std::endl;
+        return;
+    }
+
+#if 0 /* FIXME: Not a signature. What then? */
+    if (*static_cast<uint16_t const * const>(stream_buffer) != 0x0022)
+    {
+        _err << "Invalid signature for Symbol stream in '" << _pdb_file << "'" << std::endl;
+        return;
+    }
+#endif
+
+    walk_failed(walk_symbol_records(stream_buffer, stream->stream_size, visitor), stream_kind_sym, 0);
+
+    return;
+}
+
+/* I/O per stream, by index and role */
+void pdb_file_t::print_io()
+{
+    uint32_t entry;
+
+    print_io_header(_err);
+    print_io_stats(_err, "directory", _directory_io);
+    for (entry = 0; entry < _streams_io.size(); ++entry)
+    {
+        std::ostringstream name;
+
+        if (_root_stream->streams[entry].stream_size == 0 || _root_stream->streams[entry].stream_size == (uint32_t)-1)
+        {
+            continue;
+        }
+
+        name << entry << " (" << stream_kind_names[stream_kind(entry)] << ")";
+        print_io_stats(_err, name.str(), _streams_io[entry]);
+    }
+}
+
+/* From the decoded symbols, the symbols decoder is left as is */
+void pdb_file_t::histogram_symbols(uint16_t stream_index)
+{
+    records_histograms_t & histograms = _histograms[stream_index];
+    uint32_t symbol;
+
+    histograms.kind = stream_kind_sym;
+    histograms.records = _symbols.size();
+    for (symbol = 0; symbol < _symbols.size(); ++symbol)
+    {
+        ++histograms.kinds[_symbols.kind(symbol)];
+        histograms.lengths.add(_symbols.length(symbol));
+        histograms.name_lengths.add(_names.name(_symbols.name_id(symbol)).size());
+    }
+}
+
+/* Where names are depends on the leaf, they aren't looked for */
+void pdb_file_t::histogram_types(uint16_t stream_index, tpi_header_t const * const tpi_header, uint32_t stream_size)
+{
+    records_histograms_t & histograms = _histograms[stream_index];
+    type_record_t type;
+    char const * record;
+    char const * end;
+    record_walk_t walk;
+
+    histograms.kind = stream_kind_tpi;
+    histograms.records = 0;
+    for (walk = type_records_bounds(tpi_header, stream_size, &record, &end);
+         walk == record_walk_done && (walk = next_type_record(&record, end, &type)) == record_walk_done && type.data != 0; )
+    {
+        ++histograms.records;
+        ++histograms.kinds[type.kind];
+        histograms.lengths.add(type.length);
+    }
+
+    walk_failed(walk, stream_kind_tpi, histograms.records);
+}
+
+void pdb_file_t::print_histograms()
+{
+    for (std::map<uint16_t, records_histograms_t>::const_iterator it = _histograms.begin(); it != _histograms.end(); ++it)
+    {
+        records_histograms_t const & histograms = it->second;
+
+        _out << "Stream " << it->first << " (" << stream_kind_names[histograms.kind] << "): " << histograms.records << " records" << std::endl;
+        _out << "  kinds:";
+        for (std::map<uint16_t, uint64_t>::const_iterator kind = histograms.kinds.begin(); kind != histograms.kinds.end(); ++kind)
+        {
+            print_format(_out, " %#06x:%" PRIu64, kind->first, kind->second);
+        }
+        _out << std::endl;
+        _out << "  record lengths: ";
+        histograms.lengths.print(_out);
+        if (histograms.kind == stream_kind_sym)
+        {
+            _out << "  name lengths: ";
+            histograms.name_lengths.print(_out);
+        }
+    }
+}
+
+void pdb_file_t::print_symbols()
+{
+    uint32_t symbol;
+
+    for (symbol = 0; symbol < _symbols.size(); ++symbol)
+    {
+        print_format(_out, "At %#04x:%#010x, ", _symbols.segment(symbol), _symbols.offset(symbol));
+        _out << _names.name(_symbols.name_id(symbol)) << std::endl;
+    }
+}
+
+void pdb_file_t::build_dictionary()
+{
+    if (_dictionary_built)
+    {
+        return;
+    }
+
+    phase_scope_t scope(phases(), phase_index);
+
+    _dictionary.build(_names);
+    _dictionary_built = true;
+}
+
+void pdb_file_t::list_prefixes()
+{
+    uint64_t names_size = 0;
+    uint32_t name;
+
+    build_dictionary();
+
+    if (_options.stats)
+    {
+        for (name = 0; name < _names.size(); ++name)
+        {
+            names_size += _names.name(name).size();
+        }
+
+        /* The dictionary comes on top of the names, which still live in the stream buffers */
+        _err << "Names of '" << _pdb_file << "': " << _dictionary.size() << " names, " << names_size << "B of names in "
+             << _names.buffers_size() << "B of stream buffers, table " << _names.memory_size() << "B, dictionary "
+             << _dictionary.memory_size() << "B, total " << _names.buffers_size() + _names.memory_size() + _dictionary.memory_size()
+             << "B" << std::endl;
+    }
+
+    phase_scope_t scope(phases(), phase_output);
+
+    for (std::vector<std::string>::const_iterator it = _options.prefixes.begin(); it != _options.prefixes.end(); ++it)
+    {
+        std::vector<symbol_t> matches;
+
+        find_prefix(*it, matches);
+
+        _out << "Prefix '" << *it << "': " << matches.size() << " symbols" << std::endl;
+        for (std::vector<symbol_t>::const_iterator match = matches.begin(); match != matches.end(); ++match)
+        {
+            print_format(_out, "At %#04x:%#010x, ", match->segment, match->offset);
+            _out << match->name << std::endl;
+        }
+    }
+}
+
+int pdb_file_t::build_address_index()
+{
+    if (_address_index_built)
+    {
+        return 0;
+    }
+
+    phase_scope_t scope(phases(), phase_index);
+
+    if (_address_index.build(_symbols, _options.memory_budget, _options.compress_index) == -1)
+    {
+        _err << "Failed to build address index of '" << _pdb_file << "': " << _address_index.error() << std::endl;
+        return -1;
+    }
+
+    _address_index_built = true;
+    return 0;
+}
+
+void pdb_file_t::lookup_symbols()
+{
+    if (build_address_index() == -1)
+    {
+        return;
+    }
+
+    if (_options.stats)
+    {
+        _err << "Address index of '" << _pdb_file << "': " << _symbols.size() << " symbols, " << _address_index.memory_size() << "B";
+        if (_address_index.spilled_runs() != 0)
+        {
+            _err << ", spilled " << _address_index.spilled_runs() << " runs to disk";
+        }
+        _err << std::endl;
+    }
+
+    phase_scope_t scope(phases(), phase_output);
+
+    for (std::vector<std::pair<uint16_t, uint32_t> >::const_iterator it = _options.lookups.begin(); it != _options.lookups.end(); ++it)
+    {
+        symbol_t symbol;
+
+        print_format(_out, "Lookup %#04x:%#010x: ", it->first, it->second);
+        if (!lookup(it->first, it->second, &symbol))
+        {
+            _out << "no symbol" << std::endl;
+            continue;
+        }
+
+        _out << symbol.name;
+        if (it->second != symbol.offset)
+        {
+            print_format(_out, "+%#x", it->second - symbol.offset);
+        }
+        _out << std::endl;
+    }
+}
+
+int pdb_file_t::open_file()
+{
+    if (_io.open(_pdb_file.c_str(), _options.io_backend) == -1)
+    {
+        _err << "Cannot open file '" << _pdb_file << "'. Error : " << errno << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+int pdb_file_t::open()
+{
+    if (open_file() == -1)
+    {
+        return -1;
+    }
+
+    /* Read the header and validate data */
+    {
+        phase_scope_t scope(phases(), phase_header);
+
+        if (validate_header() == -1)
+        {
+            return -1;
+        }
+    }
+
+    /* Read the root stream */
+    {
+        phase_scope_t scope(phases(), phase_root);
+
+        if (open_root_stream() == -1)
+        {
+            return -1;
+        }
+    }
+
+    if (_options.stats)
+    {
+        _streams_io.resize(_root_stream->count);
+    }
+
+    return 0;
+}
+
+uint16_t pdb_file_t::streams_count() const
+{
+    return (_root_stream != 0 ? _root_stream->count : 0);
+}
+
+uint32_t pdb_file_t::stream_size(uint16_t stream_index) const
+{
+    uint32_t size;
+
+    if (stream_index >= streams_count())
+    {
+        return 0;
+    }
+
+    /* Free streams are empty */
+    size = _root_stream->streams[stream_index].stream_size;
+    return (size == (uint32_t)-1 ? 0 : size);
+}
+
+/* Pages lists of the streams follow each other, after the streams sizes */
+uint16_t const * pdb_file_t::stream_pages_list(uint16_t stream_index, uint32_t * pages) const
+{
+    uint16_t const * pages_list;
+    uint16_t entry;
+
+    pages_list = (uint16_t const *)((char *)_root_stream + offsetof(pdb_root_t, streams) + _root_stream->count * sizeof(pdb_stream_t));
+    for (entry = 0; entry <= stream_index; ++entry)
+    {
+        *pages = (stream_size(entry) == 0 ? 0 : stream_size(entry) / _header.page_size + 1);
+        if (entry != stream_index)
+        {
+            pages_list += *pages;
+        }
+    }
+
+    if ((char const *)(pages_list + *pages) > (char const *)_root_stream + _header.root_stream.stream_size)
+    {
+        _err << "Pages list of stream " << stream_index << " beyond the root stream of '" << _pdb_file << "'" << std::endl;
+        return 0;
+    }
+
+    return pages_list;
+}
+
+void * pdb_file_t::fetch_stream(uint16_t stream_index)
+{
+    uint16_t const * pages_list;
+    uint32_t pages;
+
+    if (stream_index >= streams_count() || stream_size(stream_index) == 0)
+    {
+        _err << "No stream " << stream_index << " in '" << _pdb_file << "'" << std::endl;
+        return 0;
+    }
+
+    pages_list = stream_pages_list(stream_index, &pages);
+    if (pages_list == 0)
+    {
+        return 0;
+    }
+
+    phase_scope_t scope(phases(), (uint32_t)phase_fetch + stream_kind(stream_index), stream_index);
+
+    return fetch_stream(&_root_stream->streams[stream_index], pages, pages_list, stream_io(stream_index));
+}
+
+int pdb_file_t::read_stream_data(uint16_t stream_index, std::vector<char> & data)
+{
+    void * stream_buffer;
+    uint32_t size;
+
+    data.clear();
+    size = stream_size(stream_index);
+    if (stream_index < streams_count() && size == 0)
+    {
+        return 0;
+    }
+
+    stream_buffer = fetch_stream(stream_index);
+    if (stream_buffer == 0)
+    {
+        return -1;
+    }
+
+    data.assign((char *)stream_buffer, (char *)stream_buffer + size);
+    buffer_pool_t::instance().release(stream_buffer, size);
+    return 0;
+}
+
+/* The PDB header tells how to read the DBI header, which tells where the
+ * symbols are */
+int pdb_file_t::parse_headers()
+{
+    static const uint16_t headers[] = { type_pdb_header_t, type_dbi };
+    void * stream_buffer;
+    uint32_t header;
+    int ret;
+
+    for (header = 0; header < sizeof(headers) / sizeof(headers[0]); ++header)
+    {
+        pdb_stream_t const * stream;
+
+        stream_buffer = fetch_stream(headers[header]);
+        if (stream_buffer == 0)
+        {
+            return -1;
+        }
+
+        stream = &_root_stream->streams[headers[header]];
+        {
+            phase_scope_t scope(phases(), (uint32_t)phase_decode + stream_kind(headers[header]), headers[header]);
+
+            if (headers[header] == type_pdb_header_t)
+            {
+                ret = parse_pdb_header(stream, static_cast<pdb_stream_header_ex_t *>(stream_buffer));
+            }
+            else
+            {
+                ret = (this->*_decoders->parse_dbi)(stream, stream_buffer);
+            }
+        }
+
+        buffer_pool_t::instance().release(stream_buffer, stream->stream_size);
+        if (ret == -1)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int pdb_file_t::locate_symbols()
+{
+    if (parse_headers() == -1)
+    {
+        return -1;
+    }
+
+    if (stream_kind(_sym_stream) != stream_kind_sym)
+    {
+        _err << "No symbol stream in '" << _pdb_file << "'" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+int pdb_file_t::load_symbols()
+{
+    void * stream_buffer;
+
+    if (locate_symbols() == -1)
+    {
+        return -1;
+    }
+
+    stream_buffer = fetch_stream(_sym_stream);
+    if (stream_buffer == 0)
+    {
+        return -1;
+    }
+
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_decode + stream_kind_sym, _sym_stream);
+
+        decode_stream(&_root_stream->streams[_sym_stream], _sym_stream, stream_kind_sym, stream_buffer);
+    }
+
+    _address_index_built = false;
+    _dictionary_built = false;
+    return 0;
+}
+
+/* Reports how a records walk stopped, -1 if it didn't reach the end */
+int pdb_file_t::walk_failed(record_walk_t walk, stream_kind_t kind, uint32_t records)
+{
+    switch (walk)
+    {
+        case record_walk_done:
+            return 0;
+
+        case record_walk_unsupported:
+            if (kind == stream_kind_dbi)
+            {
+                _err << "Unsupported section contributions version in " << _pdb_file << std::endl;
+            }
+            else
+            {
+                _err << "Unsupported symbol version in " << _pdb_file << " symbols stream" << std::endl;
+            }
+            break;
+
+        case record_walk_corrupted:
+            if (kind == stream_kind_tpi)
+            {
+                _err << "Type record " << records << " corrupted in " << _pdb_file << std::endl;
+            }
+            else if (kind == stream_kind_dbi)
+            {
+                _err << "DBI substream record " << records << " corrupted in " << _pdb_file << std::endl;
+            }
+            else
+            {
+                _err << "Symbol stream corrupted in " << _pdb_file << std::endl;
+            }
+            break;
+    }
+
+    return -1;
+}
+
+std::shared_ptr<records_buffer_t const> pdb_file_t::fetch_records(uint16_t stream_index)
+{
+    void * stream_buffer;
+
+    stream_buffer = fetch_stream(stream_index);
+    if (stream_buffer == 0)
+    {
+        return std::shared_ptr<records_buffer_t const>();
+    }
+
+    return std::make_shared<records_buffer_t const>(this, stream_index, stream_buffer, stream_size(stream_index));
+}
+
+symbols_view_t pdb_file_t::symbols()
+{
+    if (locate_symbols() == -1)
+    {
+        return symbols_view_t();
+    }
+
+    return symbols_view_t(fetch_records(_sym_stream));
+}
+
+types_view_t pdb_file_t::types()
+{
+    /* No types */
+    if (type_tpi < streams_count() && stream_size(type_tpi) == 0)
+    {
+        return types_view_t();
+    }
+
+    return types_view_t(fetch_records(type_tpi));
+}
+
+/* Older DBI streams have no modules */
+modules_view_t pdb_file_t::modules()
+{
+    if (parse_headers() == -1 || _format == pdb_format_2)
+    {
+        return modules_view_t();
+    }
+
+    return modules_view_t(fetch_records(type_dbi));
+}
+
+contributions_view_t pdb_file_t::section_contributions()
+{
+    if (parse_headers() == -1 || _format == pdb_format_2)
+    {
+        return contributions_view_t();
+    }
+
+    return contributions_view_t(fetch_records(type_dbi));
+}
+
+int pdb_file_t::type_hashes(std::vector<char> & tpi_stream, std::vector<type_hash_t> & hashes)
+{
+    record_walk_t walk;
+
+    hashes.clear();
+    if (read_stream_data(type_tpi, tpi_stream) == -1)
+    {
+        return -1;
+    }
+
+    /* No types */
+    if (tpi_stream.empty())
+    {
+        return 0;
+    }
+
+    if (tpi_stream.size() < sizeof(tpi_header_t))
+    {
+        return walk_failed(record_walk_corrupted, stream_kind_tpi, 0);
+    }
+
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_decode + stream_kind_tpi, type_tpi);
+
+        walk = hash_type_records((tpi_header_t const *)&tpi_stream[0], tpi_stream.size(), hashes);
+    }
+
+    return walk_failed(walk, stream_kind_tpi, hashes.size());
+}
+
+records_buffer_t::records_buffer_t(pdb_file_t * file, uint16_t stream_index, void * buffer, uint32_t size) : _file(file), _stream_index(stream_index), _buffer(buffer), _size(size)
+{
+}
+
+records_buffer_t::~records_buffer_t()
+{
+    buffer_pool_t::instance().release(_buffer, _size);
+}
+
+void records_buffer_t::failed(record_walk_t walk, uint32_t records) const
+{
+    _file->walk_failed(walk, _file->stream_kind(_stream_index), records);
+}
+
+symbol_t pdb_file_t::symbol(uint32_t symbol) const
+{
+    symbol_t found;
+
+    found.segment = _symbols.segment(symbol);
+    found.offset = _symbols.offset(symbol);
+    found.kind = _symbols.kind(symbol);
+    found.type_index = _symbols.type_index(symbol);
+    found.name = _names.name(_symbols.name_id(symbol));
+
+    return found;
+}
+
+bool pdb_file_t::lookup(uint16_t segment, uint32_t offset, symbol_t * symbol)
+{
+    uint32_t found;
+
+    if (build_address_index() == -1 || !_address_index.find(segment, offset, &found))
+    {
+        return false;
+    }
+
+    *symbol = this->symbol(found);
+    return true;
+}
+
+/* Symbols whose name starts with the prefix, in name order */
+void pdb_file_t::find_prefix(std::string_view prefix, std::vector<symbol_t> & symbols)
+{
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> ranks;
+    std::vector<uint32_t> matches;
+    uint32_t name;
+    uint32_t symbol;
+
+    symbols.clear();
+    build_dictionary();
+    _dictionary.enumerate_prefix(prefix, ids);
+
+    /* Rank matching names in name order, then pick their symbols with a single scan of the name ids */
+    ranks.assign(_names.size(), 0);
+    for (name = 0; name < ids.size(); ++name)
+    {
+        ranks[ids[name]] = name + 1;
+    }
+
+    for (symbol = 0; symbol < _symbols.size(); ++symbol)
+    {
+        if (ranks[_symbols.name_id(symbol)] != 0)
+        {
+            matches.push_back(symbol);
+        }
+    }
+
+    std::stable_sort(matches.begin(), matches.end(), [this, &ranks](uint32_t a, uint32_t b)
+                     { return ranks[_symbols.name_id(a)] < ranks[_symbols.name_id(b)]; });
+
+    symbols.reserve(matches.size());
+    for (std::vector<uint32_t>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+    {
+        symbols.push_back(this->symbol(*it));
+    }
+}
+
+void * pdb_file_t::fetch_stream(pdb_stream_t const * const stream, uint32_t pages, uint16_t const * const pages_list, io_stats_t * stats)
+{
+    void * stream_buffer;
+    uint32_t stream_size;
+
+    if (pages == 0)
+    {
+        return 0;
+    }
+
+    stream_size = stream->stream_size;
+    stream_buffer = buffer_pool_t::instance().acquire(stream_size);
+    if (stream_buffer == 0)
+    {
+        return 0;
+    }
+
+    if (read_pages(stream_buffer, stream_size, pages, pages_list, "stream", _err, stats) == -1)
+    {
+        buffer_pool_t::instance().release(stream_buffer, stream_size);
+        return 0;
+    }
+
+    return stream_buffer;
+}
+
+stream_kind_t pdb_file_t::stream_kind(uint16_t stream_index) const
+{
+    switch (stream_index)
+    {
+        case type_root_t:
+            return stream_kind_root;
+
+        case type_pdb_header_t:
+            return stream_kind_pdb_header;
+
+        case type_tpi:
+            return stream_kind_tpi;
+
+        case type_dbi:
+            return stream_kind_dbi;
+
+        case type_fpo:
+            return stream_kind_fpo;
+
+        default:
+            break;
+    }
+
+    if (_gs_stream < _root_stream->count && _gs_stream > type_fpo && stream_index == _gs_stream)
+    {
+        return stream_kind_gs;
+    }
+    if (_ps_stream < _root_stream->count && _ps_stream > type_fpo && stream_index == _ps_stream)
+    {
+        return stream_kind_ps;
+    }
+    if (_sym_stream < _root_stream->count && _sym_stream > type_fpo && stream_index == _sym_stream)
+    {
+        return stream_kind_sym;
+    }
+
+    return stream_kind_unknown;
+}
+
+void pdb_file_t::decode_stream(pdb_stream_t const * const stream, uint16_t stream_index, stream_kind_t kind, void * stream_buffer)
+{
+    switch (kind)
+    {
+        case stream_kind_root:
+            read_stream_root_t(stream, stream_index, stream_buffer);
+            break;
+
+        case stream_kind_pdb_header:
+            read_stream_pdb_header_t(stream, stream_index, static_cast<pdb_stream_header_ex_t *>(stream_buffer));
+            break;
+
+        case stream_kind_tpi:
+            read_stream_tpi(stream, stream_index, static_cast<tpi_header_t *>(stream_buffer));
+            break;
+
+        case stream_kind_dbi:
+            read_stream_dbi(stream, stream_index, stream_buffer);
+            break;
+
+        case stream_kind_fpo:
+            read_stream_fpo(stream, stream_index, stream_buffer);
+            break;
+
+        case stream_kind_gs:
+            read_stream_gs(stream, stream_index, stream_buffer);
+            break;
+
+        case stream_kind_ps:
+            read_stream_ps(stream, stream_index, stream_buffer);
+            break;
+
+        case stream_kind_sym:
+            read_stream_sym(stream, stream_index, stream_buffer);
+            if (_options.histograms)
+            {
+                histogram_symbols(stream_index);
+            }
+            /* Symbol names are views into the buffer */
+            _names.adopt(stream_buffer, stream->stream_size);
+            stream_buffer = 0;
+            break;
+
+        default:
+            _err << "Unknown stream " << stream_index << " in " << _pdb_file << std::endl;
+            break;
+    }
+
+    buffer_pool_t::instance().release(stream_buffer, stream->stream_size);
+}
+
+void pdb_file_t::decode_stream(uint16_t stream_index, void * stream_buffer)
+{
+    decode_stream(&_root_stream->streams[stream_index], stream_index, stream_kind(stream_index), stream_buffer);
+}
+
+void pdb_file_t::decode_symbols(void const * stream_buffer, uint32_t size)
+{
+    pdb_stream_t stream;
+
+    stream.stream_size = size;
+    read_stream_sym(&stream, _sym_stream, stream_buffer);
+}
+
+void pdb_file_t::read_stream(pdb_stream_t const * const stream, uint16_t stream_index, uint32_t pages, uint16_t const * const pages_list)
+{
+    void * stream_buffer;
+    stream_kind_t kind;
+
+    kind = stream_kind(stream_index);
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_fetch + kind, stream_index);
+
+        stream_buffer = fetch_stream(stream, pages, pages_list, stream_io(stream_index));
+        if (stream_buffer == 0)
+        {
+            return;
+        }
+    }
+
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_decode + kind, stream_index);
+
+        decode_stream(stream, stream_index, kind, stream_buffer);
+    }
+
+    if (kind == stream_kind_sym)
+    {
+        phase_scope_t scope(phases(), phase_output);
+
+        print_symbols();
+    }
+}
+
+void pdb_file_t::fetch_streams(uint16_t const * const pages_list, std::vector<void *> & buffers, std::vector<std::string> & errors)
+{
+    std::vector<uint16_t const *> streams_pages(_root_stream->count);
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> next(0);
+    uint32_t total_pages = 0;
+    uint16_t entry;
+    uint32_t worker;
+
+    buffers.assign(_root_stream->count, 0);
+    errors.assign(_root_stream->count, std::string());
+
+    /* Buffers come from this thread's pool, workers only read */
+    for (entry = 0; entry < _root_stream->count; ++entry)
+    {
+        pdb_stream_t const * stream = &_root_stream->streams[entry];
+
+        streams_pages[entry] = pages_list + total_pages;
+        if (stream->stream_size == 0 || stream->stream_size == (uint32_t)-1)
+        {
+            continue;
+        }
+
+        total_pages += stream->stream_size / _header.page_size + 1;
+        buffers[entry] = buffer_pool_t::instance().acquire(stream->stream_size);
+    }
+
+    for (worker = 0; worker < _options.stream_jobs && worker < _root_stream->count; ++worker)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            uint32_t current;
+
+            while ((current = next++) < _root_stream->count)
+            {
+                pdb_stream_t const * stream = &_root_stream->streams[current];
+                std::ostringstream err;
+
+                if (buffers[current] == 0)
+                {
+                    continue;
+                }
+
+                /* Traced only, the whole prefetch is accounted by the caller */
+                phase_scope_t scope(0, phase_prefetch, current);
+
+                if (read_pages(buffers[current], stream->stream_size, stream->stream_size / _header.page_size + 1, streams_pages[current], "stream", err, stream_io(current)) == -1)
+                {
+                    /* Reported, in streams order, by the caller */
+                    errors[current] = err.str();
+                }
+            }
+        }));
+    }
+
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+        it->join();
+    }
+
+    for (entry = 0; entry < _root_stream->count; ++entry)
+    {
+        if (!errors[entry].empty())
+        {
+            buffer_pool_t::instance().release(buffers[entry], _root_stream->streams[entry].stream_size);
+            buffers[entry] = 0;
+        }
+    }
+}
+
+void pdb_file_t::extract_pdb()
+{
+    uint16_t entry;
+    uint32_t total_pages = 0;
+    uint16_t * pages_list;
+    std::vector<void *> buffers;
+    std::vector<std::string> errors;
+    bool prefetch;
+    trace_span_t span;
+
+    if (trace_t::enabled())
+    {
+        span.begin("file", _pdb_file, "{\"file\":\"" + json_escape(_pdb_file) + "\"}");
+    }
+
+    if (open() == -1)
+    {
+        return;
+    }
+
+    total_pages = 0;
+    pages_list = (uint16_t *)((char *)_root_stream + offsetof(pdb_root_t, streams) + _root_stream->count * sizeof(pdb_stream_t));
+
+    /* stdio reads can't happen concurrently */
+    prefetch = (_options.stream_jobs > 1 && _options.io_backend != io_backend_stdio);
+    if (prefetch)
+    {
+        phase_scope_t scope(phases(), phase_prefetch);
+
+        fetch_streams(pages_list, buffers, errors);
+    }
+
+    for (entry = 0; entry < _root_stream->count; ++entry)
+    {
+        pdb_stream_t * stream;
+        uint32_t pages;
+
+        stream = &_root_stream->streams[entry];
+        pages = stream->stream_size / _header.page_size + 1;
+        if (stream->stream_size == 0 || stream->stream_size == -1)
+        {
+            pages = 0;
+        }
+
+        if (!prefetch)
+        {
+            read_stream(stream, entry, pages, pages_list + total_pages);
+        }
+        else
+        {
+            _err << errors[entry];
+            if (buffers[entry] != 0)
+            {
+                stream_kind_t kind = stream_kind(entry);
+
+                {
+                    phase_scope_t scope(phases(), (uint32_t)phase_decode + kind, entry);
+
+                    decode_stream(stream, entry, kind, buffers[entry]);
+                }
+
+                if (kind == stream_kind_sym)
+                {
+                    phase_scope_t scope(phases(), phase_output);
+
+                    print_symbols();
+                }
+            }
+        }
+
+        total_pages += pages;
+    }
+
+    if (_options.histograms)
+    {
+        print_histograms();
+    }
+
+    if (!_options.lookups.empty())
+    {
+        lookup_symbols();
+    }
+
+    if (!_options.prefixes.empty())
+    {
+        list_prefixes();
+    }
+
+    return;
+}
+
+/* Processes the files, several at once with jobs. Each file's output is
+ * then buffered, and written once all the previous files' output is */
+void extract_files(std::vector<char const *> const & files, pdb_options_t const & options, std::ostream & out, std::ostream & err)
+{
+    std::vector<std::string> outputs(files.size());
+    std::vector<std::string> errors(files.size());
+    std::vector<bool> done(files.size(), false);
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> next(0);
+    std::mutex lock;
+    std::condition_variable finished;
+    uint32_t worker;
+    uint32_t file;
+
+    if (options.jobs <= 1)
+    {
+        for (std::vector<char const *>::const_iterator it = files.begin(); it != files.end(); ++it)
+        {
+            pdb_file_t pdb_file(*it, options, out, err);
+
+            pdb_file.extract_pdb();
+        }
+
+        return;
+    }
+
+    for (worker = 0; worker < options.jobs && worker < files.size(); ++worker)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            uint32_t current;
+
+            while ((current = next++) < files.size())
+            {
+                std::ostringstream out;
+                std::ostringstream err;
+
+                {
+                    pdb_file_t pdb_file(files[current], options, out, err);
+
+                    pdb_file.extract_pdb();
+                }
+
+                std::lock_guard<std::mutex> guard(lock);
+                outputs[current] = out.str();
+                errors[current] = err.str();
+                done[current] = true;
+                finished.notify_one();
+            }
+
+            buffer_pool_t::retire();
+        }));
+    }
+
+    for (file = 0; file < files.size(); ++file)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        finished.wait(guard, [&]() { return done[file]; });
+
+        trace_span_t span;
+        if (trace_t::enabled())
+        {
+            span.begin("output", "flush", "{\"file\":\"" + json_escape(files[file]) + "\"}");
+        }
+
+        out << outputs[file] << std::flush;
+        err << errors[file];
+        std::string().swap(outputs[file]);
+        std::string().swap(errors[file]);
+    }
+
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+        it->join();
+    }
+}
+
+uint64_t hash_bytes(void const * const data, size_t size, uint64_t seed)
+{
+    uint64_t const multiplier = 0xC6A4A7935BD1E995ULL;
+    unsigned char const * bytes = (unsigned char const *)data;
+    unsigned char const * const end = bytes + (size & ~(size_t)7);
+    uint64_t hash = seed ^ (size * multiplier);
+    uint64_t word;
+
+    for (; bytes != end; bytes += sizeof(uint64_t))
+    {
+        memcpy(&word, bytes, sizeof(word));
+        word *= multiplier;
+        word ^= word >> 47;
+        word *= multiplier;
+        hash ^= word;
+        hash *= multiplier;
+    }
+
+    if ((size & 7) != 0)
+    {
+        word = 0;
+        memcpy(&word, bytes, size & 7);
+        hash ^= word;
+        hash *= multiplier;
+    }
+
+    hash ^= hash >> 47;
+    hash *= multiplier;
+    hash ^= hash >> 47;
+    return hash;
+}
+
+/* Type indexes are substituted in order: records only reference the ones
+ * before them, whose hashes are known. Basic types, below min_ti, are
+ * the same in all files and stay as they are */
+record_walk_t hash_type_records(tpi_header_t const * const tpi_header, uint32_t stream_size, std::vector<type_hash_t> & hashes)
+{
+    std::string hashed;
+    char const * record;
+    char const * begin;
+    char const * end;
+    uint64_t salt = 0;
+    bool salted = false;
+    record_walk_t walk;
+
+    hashes.clear();
+    walk = type_records_bounds(tpi_header, stream_size, &begin, &end);
+    if (walk != record_walk_done)
+    {
+        return walk;
+    }
+
+    /* Records that can't be hashed globally are hashed with the whole stream */
+    auto file_salt = [&]()
+    {
+        if (!salted)
+        {
+            salt = hash_bytes(begin, end - begin, 0);
+            salted = true;
+        }
+
+        return salt;
+    };
+
+    for (record = begin; ; )
+    {
+        type_record_t type;
+        uint32_t hashed_size = 0;
+        bool hashable;
+
+        walk = next_type_record(&record, end, &type);
+        if (walk != record_walk_done || type.data == 0)
+        {
+            return walk;
+        }
+
+        type.type_index = tpi_header->min_ti + hashes.size();
+        hashed.assign((char const *)&type.kind, sizeof(type.kind));
+        hashable = type_record_indexes(type, [&](uint32_t offset)
+        {
+            uint32_t referenced = *(uint32_t const *)(type.data + offset);
+            type_hash_t hash;
+
+            if (referenced < tpi_header->min_ti)
+            {
+                hash = referenced;
+            }
+            else if (referenced < type.type_index)
+            {
+                hash = hashes[referenced - tpi_header->min_ti];
+            }
+            else
+            {
+                hash = hash_bytes(&referenced, sizeof(referenced), file_salt());
+            }
+
+            hashed.append(type.data + hashed_size, offset - hashed_size);
+            hashed.append((char const *)&hash, sizeof(hash));
+            hashed_size = offset + sizeof(uint32_t);
+        });
+
+        if (hashable)
+        {
+            hashed.append(type.data + hashed_size, type.length - 2 * sizeof(uint16_t) - hashed_size);
+            hashes.push_back(hash_bytes(hashed.data(), hashed.size(), 0));
+        }
+        else
+        {
+            hashes.push_back(hash_bytes(type.data - sizeof(uint16_t), type.length - sizeof(uint16_t), file_salt()));
+        }
+    }
+}
+
+/* Records are looked up first, so that the indexes of all the new ones are
+ * known when their references are rewritten */
+uint32_t type_store_t::add(tpi_header_t const * const tpi_header, uint32_t stream_size, std::vector<type_hash_t> const & hashes, std::vector<uint32_t> & indexes)
+{
+    std::vector<char const *> records;
+    std::vector<uint32_t> added;
+    char const * record;
+    char const * end;
+    uint32_t local;
+
+    indexes.clear();
+    if (hashes.empty() || type_records_bounds(tpi_header, stream_size, &record, &end) != record_walk_done)
+    {
+        return 0;
+    }
+
+    for (local = 0; local < hashes.size(); ++local)
+    {
+        std::pair<std::unordered_map<type_hash_t, uint32_t>::iterator, bool> inserted;
+        type_record_t found;
+
+        records.push_back(record);
+        if (next_type_record(&record, end, &found) != record_walk_done || found.data == 0)
+        {
+            break;
+        }
+
+        inserted = _indexes.try_emplace(hashes[local], min_ti + _offsets.size() + added.size());
+        if (inserted.second)
+        {
+            added.push_back(local);
+        }
+
+        indexes.push_back(inserted.first->second);
+    }
+
+    for (std::vector<uint32_t>::const_iterator it = added.begin(); it != added.end(); ++it)
+    {
+        type_record_t copy;
+        uint32_t length = *(uint16_t const *)records[*it] + sizeof(uint16_t);
+
+        _offsets.push_back(_records.size());
+        _hashes.push_back(hashes[*it]);
+        _records.insert(_records.end(), records[*it], records[*it] + length);
+
+        copy = type(min_ti + _offsets.size() - 1);
+        type_record_indexes(copy, [&](uint32_t offset)
+        {
+            uint32_t * referenced = (uint32_t *)(copy.data + offset);
+
+            if (*referenced >= tpi_header->min_ti && *referenced - tpi_header->min_ti < indexes.size())
+            {
+                *referenced = indexes[*referenced - tpi_header->min_ti];
+            }
+        });
+    }
+
+    return added.size();
+}
+
+type_record_t type_store_t::type(uint32_t type_index) const
+{
+    char const * record = &_records[_offsets[type_index - min_ti]];
+    type_record_t type;
+
+    type.type_index = type_index;
+    type.length = *(uint16_t const *)record + sizeof(uint16_t);
+    type.kind = *(uint16_t const *)(record + sizeof(uint16_t));
+    type.data = record + 2 * sizeof(uint16_t);
+    return type;
+}
+
+uint32_t type_store_t::find(type_hash_t hash) const
+{
+    std::unordered_map<type_hash_t, uint32_t>::const_iterator found = _indexes.find(hash);
+
+    return found == _indexes.end() ? 0 : found->second;
+}
+
+void type_store_t::tpi_stream(std::vector<char> & stream) const
+{
+    tpi_header_t header;
+
+    header.version = tpi_version_6;
+    header.header_size = sizeof(header);
+    header.min_ti = min_ti;
+    header.max_ti = min_ti + _offsets.size();
+    header.size = _records.size();
+
+    stream.assign((char const *)&header, (char const *)&header + sizeof(header));
+    stream.insert(stream.end(), _records.begin(), _records.end());
+}
+
+/* A file of merge_types(), hashed but not merged yet */
+struct merged_file_t
+{
+    int ret;
+    std::vector<char> tpi_stream;
+    std::vector<type_hash_t> hashes;
+    std::string errors;
+};
+
+int merge_types(std::vector<char const *> const & files, pdb_options_t const & options, type_store_t & store, std::ostream & out, std::ostream & err)
+{
+    std::vector<merged_file_t> hashed(files.size());
+    std::vector<bool> done(files.size(), false);
+    std::vector<std::thread> workers;
+    std::vector<uint32_t> indexes;
+    std::atomic<uint32_t> next(0);
+    std::mutex lock;
+    std::condition_variable finished;
+    uint32_t merged = 0;
+    uint32_t jobs = std::max(options.jobs, 1U);
+    uint64_t types = 0;
+    int ret = 0;
+    uint32_t worker;
+    uint32_t file;
+
+    auto hash_file = [&](uint32_t current)
+    {
+        std::ostringstream file_err;
+        pdb_file_t pdb_file(files[current], options, out, file_err);
+
+        hashed[current].ret = pdb_file.open();
+        if (hashed[current].ret == 0)
+        {
+            hashed[current].ret = pdb_file.type_hashes(hashed[current].tpi_stream, hashed[current].hashes);
+        }
+        hashed[current].errors = file_err.str();
+    };
+
+    /* Workers stay a few files ahead of the merge, that is done in order */
+    for (worker = 0; jobs > 1 && worker < jobs && worker < files.size(); ++worker)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            uint32_t current;
+
+            while ((current = next++) < files.size())
+            {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+
+                    finished.wait(guard, [&]() { return current < merged + 2 * jobs; });
+                }
+
+                hash_file(current);
+
+                std::lock_guard<std::mutex> guard(lock);
+                done[current] = true;
+                finished.notify_all();
+            }
+
+            buffer_pool_t::retire();
+        }));
+    }
+
+    for (file = 0; file < files.size(); ++file)
+    {
+        merged_file_t & current = hashed[file];
+        uint32_t added;
+
+        if (jobs > 1)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+
+            finished.wait(guard, [&]() { return done[file]; });
+        }
+        else
+        {
+            hash_file(file);
+        }
+
+        err << current.errors;
+        if (current.ret == -1)
+        {
+            ret = -1;
+        }
+        else
+        {
+            added = current.hashes.empty() ? 0 : store.add((tpi_header_t const *)&current.tpi_stream[0], current.tpi_stream.size(), current.hashes, indexes);
+            types += current.hashes.size();
+            out << files[file] << ": " << current.hashes.size() << " types, " << added << " new" << std::endl;
+        }
+
+        std::vector<char>().swap(current.tpi_stream);
+        std::vector<type_hash_t>().swap(current.hashes);
+
+        std::lock_guard<std::mutex> guard(lock);
+        ++merged;
+        finished.notify_all();
+    }
+
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+        it->join();
+    }
+
+    out << "Types: " << types << " in " << files.size() << " files, " << store.types_count() << " unique" << std::endl;
+    return ret;
+}
+
+/* What diff_files() compares of a file. Items are sorted on the hash of
+ * their name first, so that the two files are merged in one pass */
+struct diff_symbol_t
+{
+    uint64_t hash;
+    std::string_view name;
+    uint16_t kind;
+    /* Global hash of the type, which renumbering doesn't change, or the
+     * index of basic types (below min_ti) */
+    uint64_t type;
+    /* Up to the next symbol of the segment, 0 for the last one */
+    uint32_t size;
+};
+
+struct diff_module_t
+{
+    uint64_t hash;
+    std::string_view name;
+    std::string_view object_name;
+    /* Of all its section contributions */
+    uint64_t size;
+};
+
+struct diff_snapshot_t
+{
+    int ret;
+    std::vector<diff_symbol_t> symbols;
+    /* Symbol names point into it, they aren't interned */
+    symbols_view_t symbols_records;
+    /* Kind and global hash of each type record */
+    std::vector<std::pair<uint16_t, uint64_t> > types;
+    std::vector<diff_module_t> modules;
+    /* Module names point into it */
+    modules_view_t modules_records;
+    std::map<uint16_t, uint64_t> sections;
+    std::vector<uint32_t> stream_sizes;
+    std::vector<stream_kind_t> stream_kinds;
+};
+
+static bool diff_symbol_less(diff_symbol_t const & first, diff_symbol_t const & second)
+{
+    if (first.hash != second.hash)
+    {
+        return first.hash < second.hash;
+    }
+
+    return first.name < second.name;
+}
+
+/* Symbols of the same name are matched in this order */
+static bool diff_symbol_order(diff_symbol_t const & first, diff_symbol_t const & second)
+{
+    if (diff_symbol_less(first, second) || diff_symbol_less(second, first))
+    {
+        return diff_symbol_less(first, second);
+    }
+
+    if (first.size != second.size)
+    {
+        return first.size < second.size;
+    }
+
+    if (first.kind != second.kind)
+    {
+        return first.kind < second.kind;
+    }
+
+    return first.type < second.type;
+}
+
+static bool diff_module_less(diff_module_t const & first, diff_module_t const & second)
+{
+    if (first.hash != second.hash)
+    {
+        return first.hash < second.hash;
+    }
+
+    if (first.name != second.name)
+    {
+        return first.name < second.name;
+    }
+
+    return first.object_name < second.object_name;
+}
+
+/* Walks two sorted vectors at once. Items equal for less are matched in
+ * order, the others are only in one of them */
+template <typename item_t, typename less_t, typename removed_t, typename added_t, typename both_t>
+static void diff_merge(std::vector<item_t> const & old_items, std::vector<item_t> const & new_items, less_t less, removed_t removed, added_t added, both_t both)
+{
+    size_t old_item = 0;
+    size_t new_item = 0;
+
+    while (old_item < old_items.size() || new_item < new_items.size())
+    {
+        if (new_item == new_items.size() || (old_item < old_items.size() && less(old_items[old_item], new_items[new_item])))
+        {
+            removed(old_items[old_item++]);
+        }
+        else if (old_item == old_items.size() || less(new_items[new_item], old_items[old_item]))
+        {
+            added(new_items[new_item++]);
+        }
+        else
+        {
+            both(old_items[old_item++], new_items[new_item++]);
+        }
+    }
+}
+
+static int diff_snapshot(pdb_file_t & file, diff_snapshot_t * snapshot)
+{
+    std::vector<std::pair<uint64_t, uint32_t> > addresses;
+    std::vector<uint64_t> module_sizes;
+    std::hash<std::string_view> hash;
+    std::vector<char> tpi_stream;
+    std::vector<type_hash_t> type_hashes;
+    type_record_t type_record;
+    char const * record;
+    char const * end;
+    uint32_t min_ti = 0;
+    uint32_t symbol;
+    uint32_t type;
+    uint16_t stream;
+
+    if (file.open() == -1)
+    {
+        return -1;
+    }
+
+    for (stream = 0; stream < file.streams_count(); ++stream)
+    {
+        snapshot->stream_sizes.push_back(file.stream_size(stream));
+        snapshot->stream_kinds.push_back(file.stream_kind(stream));
+    }
+
+    /* Types compare on their kind and global hash, whatever their index */
+    if (file.type_hashes(tpi_stream, type_hashes) == 0 && !type_hashes.empty() &&
+        type_records_bounds((tpi_header_t const *)&tpi_stream[0], tpi_stream.size(), &record, &end) == record_walk_done)
+    {
+        for (type = 0; type < type_hashes.size() && next_type_record(&record, end, &type_record) == record_walk_done && type_record.data != 0; ++type)
+        {
+            snapshot->types.push_back(std::make_pair(type_record.kind, type_hashes[type]));
+        }
+
+        min_ti = ((tpi_header_t const *)&tpi_stream[0])->min_ti;
+    }
+
+    std::sort(snapshot->types.begin(), snapshot->types.end());
+
+    /* Sizes from the symbols in address order */
+    snapshot->symbols_records = file.symbols();
+    for (symbol_t const & found : snapshot->symbols_records)
+    {
+        diff_symbol_t diffed;
+
+        diffed.hash = hash(found.name);
+        diffed.name = found.name;
+        diffed.kind = found.kind;
+        diffed.type = found.type_index;
+        if (found.type_index >= min_ti && found.type_index - min_ti < type_hashes.size())
+        {
+            diffed.type = type_hashes[found.type_index - min_ti];
+        }
+        diffed.size = 0;
+        addresses.push_back(std::make_pair(((uint64_t)found.segment << 32) | found.offset, snapshot->symbols.size()));
+        snapshot->symbols.push_back(diffed);
+    }
+
+    std::sort(addresses.begin(), addresses.end());
+    for (symbol = 1; symbol < addresses.size(); ++symbol)
+    {
+        if ((addresses[symbol].first >> 32) == (addresses[symbol - 1].first >> 32))
+        {
+            snapshot->symbols[addresses[symbol - 1].second].size = addresses[symbol].first - addresses[symbol - 1].first;
+        }
+    }
+
+    std::sort(snapshot->symbols.begin(), snapshot->symbols.end(), diff_symbol_order);
+
+    for (section_contribution_t const & contribution : file.section_contributions())
+    {
+        snapshot->sections[contribution.section] += contribution.size;
+        if (contribution.module_index >= module_sizes.size())
+        {
+            module_sizes.resize(contribution.module_index + 1, 0);
+        }
+        module_sizes[contribution.module_index] += contribution.size;
+    }
+
+    /* Without section contributions, modules still have their first one */
+    snapshot->modules_records = file.modules();
+    for (module_t const & module : snapshot->modules_records)
+    {
+        diff_module_t diffed;
+
+        diffed.name = module.name;
+        diffed.object_name = module.object_name;
+        diffed.hash = hash(module.name) ^ (hash(module.object_name) * 31);
+        diffed.size = module.index < module_sizes.size() ? module_sizes[module.index] : module.size;
+        snapshot->modules.push_back(diffed);
+    }
+
+    std::sort(snapshot->modules.begin(), snapshot->modules.end(), [](diff_module_t const & first, diff_module_t const & second)
+    {
+        if (diff_module_less(first, second) || diff_module_less(second, first))
+        {
+            return diff_module_less(first, second);
+        }
+
+        return first.size < second.size;
+    });
+
+    return 0;
+}
+
+/* Lines of a section of the diff, sorted on their name when printed */
+static void print_diff(std::ostream & out, char const * const what, std::vector<std::pair<std::string, std::string> > & lines, uint32_t added, uint32_t removed, uint32_t changed)
+{
+    out << what << ": " << added << " added, " << removed << " removed, " << changed << " changed" << std::endl;
+
+    std::sort(lines.begin(), lines.end());
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator line = lines.begin(); line != lines.end(); ++line)
+    {
+        out << line->second << std::endl;
+    }
+}
+
+/* A symbol only in the old file (-), the new one (+), or changed (~) */
+struct diff_change_t
+{
+    diff_change_t(char change, diff_symbol_t const * old_symbol, diff_symbol_t const * new_symbol) : change(change), old_symbol(old_symbol), new_symbol(new_symbol)
+    {
+        uint32_t byte;
+
+        name = new_symbol != 0 ? new_symbol->name : old_symbol->name;
+        prefix = 0;
+        for (byte = 0; byte < sizeof(prefix); ++byte)
+        {
+            prefix = (prefix << 8) | (byte < name.size() ? (uint8_t)name[byte] : 0);
+        }
+    }
+
+    /* First bytes of the name, most significant first: most comparisons
+     * don't need the name */
+    uint64_t prefix;
+    std::string_view name;
+    char change;
+    diff_symbol_t const * old_symbol;
+    diff_symbol_t const * new_symbol;
+};
+
+static void append_format(std::string & text, char const * const format, ...)
+{
+    char buffer[256];
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    text.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+}
+
+/* There can be as many lines as symbols: they are formatted once sorted,
+ * and written by blocks */
+static void print_symbols_diff(std::ostream & out, std::vector<diff_change_t> & changes, uint32_t added, uint32_t removed, uint32_t changed)
+{
+    std::string text;
+
+    out << "Symbols: " << added << " added, " << removed << " removed, " << changed << " changed" << std::endl;
+
+    std::sort(changes.begin(), changes.end(), [](diff_change_t const & first, diff_change_t const & second)
+    {
+        if (first.prefix != second.prefix)
+        {
+            return first.prefix < second.prefix;
+        }
+
+        if (first.name != second.name)
+        {
+            return first.name < second.name;
+        }
+
+        return first.change < second.change;
+    });
+
+    for (std::vector<diff_change_t>::const_iterator change = changes.begin(); change != changes.end(); ++change)
+    {
+        text += change->change;
+        text += ' ';
+        text.append(change->name.data(), change->name.size());
+        if (change->change != '~')
+        {
+            append_format(text, ", %#x bytes\n", (change->new_symbol != 0 ? change->new_symbol : change->old_symbol)->size);
+        }
+        else
+        {
+            if (change->old_symbol->size != change->new_symbol->size)
+            {
+                append_format(text, ", %#x -> %#x bytes", change->old_symbol->size, change->new_symbol->size);
+            }
+            if (change->old_symbol->kind != change->new_symbol->kind)
+            {
+                append_format(text, ", kind %#06x -> %#06x", change->old_symbol->kind, change->new_symbol->kind);
+            }
+            if (change->old_symbol->type != change->new_symbol->type)
+            {
+                append_format(text, ", type %#" PRIx64 " -> %#" PRIx64, change->old_symbol->type, change->new_symbol->type);
+            }
+            text += '\n';
+        }
+
+        if (text.size() >= 0x10000)
+        {
+            out.write(text.data(), text.size());
+            text.clear();
+        }
+    }
+
+    out.write(text.data(), text.size());
+    out << std::flush;
+}
+
+static std::string diff_format(char const * const format, ...)
+{
+    char buffer[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    return buffer;
+}
+
+int diff_files(char const * const old_file, char const * const new_file, pdb_options_t const & options, std::ostream & out, std::ostream & err)
+{
+    std::ostringstream old_err;
+    std::ostringstream new_err;
+    pdb_file_t old_pdb(old_file, options, out, old_err);
+    pdb_file_t new_pdb(new_file, options, out, new_err);
+    diff_snapshot_t old_snapshot;
+    diff_snapshot_t new_snapshot;
+    std::vector<diff_change_t> symbol_changes;
+    std::vector<std::pair<std::string, std::string> > lines;
+    std::map<uint16_t, std::pair<uint32_t, uint32_t> > kinds;
+    uint32_t added = 0;
+    uint32_t removed = 0;
+    uint32_t changed = 0;
+    bool differ = false;
+    uint32_t stream;
+
+    /* Both files are read at once */
+    std::thread old_reader([&]()
+    {
+        old_snapshot.ret = diff_snapshot(old_pdb, &old_snapshot);
+        buffer_pool_t::retire();
+    });
+    new_snapshot.ret = diff_snapshot(new_pdb, &new_snapshot);
+    old_reader.join();
+
+    err << old_err.str() << new_err.str();
+    if (old_snapshot.ret == -1 || new_snapshot.ret == -1)
+    {
+        return -1;
+    }
+
+    diff_merge(old_snapshot.symbols, new_snapshot.symbols, diff_symbol_less,
+               [&](diff_symbol_t const & symbol)
+               {
+                   symbol_changes.push_back(diff_change_t('-', &symbol, 0));
+                   ++removed;
+               },
+               [&](diff_symbol_t const & symbol)
+               {
+                   symbol_changes.push_back(diff_change_t('+', 0, &symbol));
+                   ++added;
+               },
+               [&](diff_symbol_t const & old_symbol, diff_symbol_t const & new_symbol)
+               {
+                   if (old_symbol.size != new_symbol.size || old_symbol.kind != new_symbol.kind || old_symbol.type != new_symbol.type)
+                   {
+                       symbol_changes.push_back(diff_change_t('~', &old_symbol, &new_symbol));
+                       ++changed;
+                   }
+               });
+    print_symbols_diff(out, symbol_changes, added, removed, changed);
+    differ = differ || added != 0 || removed != 0 || changed != 0;
+
+    /* Types have no name to tell them apart, they are counted per kind */
+    lines.clear();
+    added = removed = changed = 0;
+    diff_merge(old_snapshot.types, new_snapshot.types, std::less<std::pair<uint16_t, uint64_t> >(),
+               [&](std::pair<uint16_t, uint64_t> const & type) { ++kinds[type.first].first; ++removed; },
+               [&](std::pair<uint16_t, uint64_t> const & type) { ++kinds[type.first].second; ++added; },
+               [&](std::pair<uint16_t, uint64_t> const &, std::pair<uint16_t, uint64_t> const &) {});
+    for (std::map<uint16_t, std::pair<uint32_t, uint32_t> >::const_iterator kind = kinds.begin(); kind != kinds.end(); ++kind)
+    {
+        lines.push_back(std::make_pair(diff_format("%04x", kind->first), diff_format("~ kind %#06x: %u added, %u removed", kind->first, kind->second.second, kind->second.first)));
+    }
+    print_diff(out, "Types", lines, added, removed, changed);
+    differ = differ || added != 0 || removed != 0;
+
+    lines.clear();
+    added = removed = changed = 0;
+    diff_merge(old_snapshot.modules, new_snapshot.modules, diff_module_less,
+               [&](diff_module_t const & module)
+               {
+                   std::string name = std::string(module.name) + " (" + std::string(module.object_name) + ")";
+
+                   lines.push_back(std::make_pair(name, "- " + name + diff_format(", %#" PRIx64 " bytes", module.size)));
+                   ++removed;
+               },
+               [&](diff_module_t const & module)
+               {
+                   std::string name = std::string(module.name) + " (" + std::string(module.object_name) + ")";
+
+                   lines.push_back(std::make_pair(name, "+ " + name + diff_format(", %#" PRIx64 " bytes", module.size)));
+                   ++added;
+               },
+               [&](diff_module_t const & old_module, diff_module_t const & new_module)
+               {
+                   std::string name = std::string(new_module.name) + " (" + std::string(new_module.object_name) + ")";
+
+                   if (old_module.size != new_module.size)
+                   {
+                       lines.push_back(std::make_pair(name, "~ " + name + diff_format(", %#" PRIx64 " -> %#" PRIx64 " bytes", old_module.size, new_module.size)));
+                       ++changed;
+                   }
+               });
+    print_diff(out, "Modules", lines, added, removed, changed);
+    differ = differ || added != 0 || removed != 0 || changed != 0;
+
+    lines.clear();
+    added = removed = changed = 0;
+    for (std::map<uint16_t, uint64_t>::const_iterator section = old_snapshot.sections.begin(); section != old_snapshot.sections.end(); ++section)
+    {
+        std::map<uint16_t, uint64_t>::const_iterator other = new_snapshot.sections.find(section->first);
+
+        if (other == new_snapshot.sections.end())
+        {
+            lines.push_back(std::make_pair(diff_format("%04x", section->first), diff_format("- section %u, %#" PRIx64 " bytes", section->first, section->second)));
+            ++removed;
+        }
+        else if (other->second != section->second)
+        {
+            lines.push_back(std::make_pair(diff_format("%04x", section->first), diff_format("~ section %u, %#" PRIx64 " -> %#" PRIx64 " bytes", section->first, section->second, other->second)));
+            ++changed;
+        }
+    }
+    for (std::map<uint16_t, uint64_t>::const_iterator section = new_snapshot.sections.begin(); section != new_snapshot.sections.end(); ++section)
+    {
+        if (old_snapshot.sections.find(section->first) == old_snapshot.sections.end())
+        {
+            lines.push_back(std::make_pair(diff_format("%04x", section->first), diff_format("+ section %u, %#" PRIx64 " bytes", section->first, section->second)));
+            ++added;
+        }
+    }
+    print_diff(out, "Section contributions", lines, added, removed, changed);
+    differ = differ || added != 0 || removed != 0 || changed != 0;
+
+    lines.clear();
+    added = removed = changed = 0;
+    for (stream = 0; stream < std::max(old_snapshot.stream_sizes.size(), new_snapshot.stream_sizes.size()); ++stream)
+    {
+        std::string key = diff_format("%05u", stream);
+
+        if (stream >= new_snapshot.stream_sizes.size())
+        {
+            lines.push_back(std::make_pair(key, diff_format("- stream %u (%s), %u bytes", stream, stream_kind_names[old_snapshot.stream_kinds[stream]], old_snapshot.stream_sizes[stream])));
+            ++removed;
+        }
+        else if (stream >= old_snapshot.stream_sizes.size())
+        {
+            lines.push_back(std::make_pair(key, diff_format("+ stream %u (%s), %u bytes", stream, stream_kind_names[new_snapshot.stream_kinds[stream]], new_snapshot.stream_sizes[stream])));
+            ++added;
+        }
+        else if (old_snapshot.stream_sizes[stream] != new_snapshot.stream_sizes[stream])
+        {
+            lines.push_back(std::make_pair(key, diff_format("~ stream %u (%s), %u -> %u bytes", stream, stream_kind_names[new_snapshot.stream_kinds[stream]], old_snapshot.stream_sizes[stream], new_snapshot.stream_sizes[stream])));
+            ++changed;
+        }
+    }
+    print_diff(out, "Streams", lines, added, removed, changed);
+    differ = differ || added != 0 || removed != 0 || changed != 0;
+
+    return differ ? 1 : 0;
+}
+
+/* A symbol of report_sizes(), in address order */
+struct sized_symbol_t
+{
+    /* Segment in the high 32 bits, offset in the low ones */
+    uint64_t address;
+    std::string_view name;
+    uint32_t size;
+};
+
+static uint32_t const no_module = 0xFFFFFFFF;
+
+/* Symbol sizes summed over a share of the symbols, merged once all are done */
+struct size_totals_t
+{
+    std::unordered_map<std::string_view, uint64_t> namespaces;
+    std::unordered_map<std::string_view, uint64_t> templates;
+    std::vector<uint64_t> modules;
+    uint64_t unattributed;
+    /* Scopes that aren't as such in names */
+    std::unordered_set<std::string> keys;
+};
+
+/* MSVC mangled names, as far as sizes are summed on them: a qualified name
+ * is made of fragments, each a name ended by '@', a template (?$name@,
+ * then its arguments, ended by '@'), or a digit referring back to one of
+ * the first ten names met. It ends with another '@'. Template arguments
+ * are only skipped over, and unhandled encodings fail the parsing */
+static uint32_t const max_mangled_depth = 16;
+
+static bool skip_mangled_type(std::string_view name, size_t & position, uint32_t depth);
+static bool skip_mangled_function_type(std::string_view name, size_t & position, uint32_t depth);
+
+/* Unsigned digit, or hexadecimal with letters A-P, ended by '@' */
+static bool skip_mangled_number(std::string_view name, size_t & position)
+{
+    if (position < name.size() && name[position] == '?')
+    {
+        ++position;
+    }
+
+    if (position < name.size() && name[position] >= '0' && name[position] <= '9')
+    {
+        ++position;
+        return true;
+    }
+
+    while (position < name.size() && name[position] >= 'A' && name[position] <= 'P')
+    {
+        ++position;
+    }
+
+    if (position >= name.size() || name[position] != '@')
+    {
+        return false;
+    }
+
+    ++position;
+    return true;
+}
+
+/* Names end at the end of the string as well, for the scopes kept by
+ * name_scopes() */
+static bool read_mangled_fragment(std::string_view name, size_t & position, std::string_view * fragment, uint32_t depth)
+{
+    size_t begin = position;
+    size_t end;
+
+    if (position >= name.size() || name[position] == '@' || depth > max_mangled_depth)
+    {
+        return false;
+    }
+
+    if (name[position] >= '0' && name[position] <= '9')
+    {
+        ++position;
+        *fragment = name.substr(begin, 1);
+        return true;
+    }
+
+    if (name.compare(position, 2, "?$") == 0)
+    {
+        end = name.find('@', position + 2);
+        if (end == std::string_view::npos || end == position + 2)
+        {
+            return false;
+        }
+
+        position = end + 1;
+        while (position < name.size() && name[position] != '@')
+        {
+            if (!skip_mangled_type(name, position, depth + 1))
+            {
+                return false;
+            }
+        }
+
+        if (position >= name.size())
+        {
+            return false;
+        }
+
+        ++position;
+        *fragment = name.substr(begin, position - begin);
+        return true;
+    }
+
+    /* Other nested names, but anonymous namespaces, aren't handled */
+    if (name[position] == '?' && name.compare(position, 2, "?A") != 0)
+    {
+        return false;
+    }
+
+    end = name.find('@', position);
+    if (end == std::string_view::npos)
+    {
+        end = name.size();
+        position = end;
+    }
+    else
+    {
+        position = end + 1;
+    }
+
+    *fragment = name.substr(begin, end - begin);
+    return true;
+}
+
+/* Up to and past the '@' ending the qualified name */
+static bool skip_mangled_qualified_name(std::string_view name, size_t & position, uint32_t depth)
+{
+    std::string_view fragment;
+
+    while (position < name.size() && name[position] != '@')
+    {
+        if (!read_mangled_fragment(name, position, &fragment, depth))
+        {
+            return false;
+        }
+    }
+
+    if (position >= name.size())
+    {
+        return false;
+    }
+
+    ++position;
+    return true;
+}
+
+/* Calling convention, return type, then parameters: X for none, or their
+ * types ended by '@' (Z alone when variadic), then Z */
+static bool skip_mangled_function_type(std::string_view name, size_t & position, uint32_t depth)
+{
+    if (position >= name.size())
+    {
+        return false;
+    }
+
+    ++position;
+    /* Qualifiers of returned classes */
+    if (position < name.size() && name[position] == '?')
+    {
+        position += 2;
+    }
+    if (!skip_mangled_type(name, position, depth))
+    {
+        return false;
+    }
+
+    if (position < name.size() && name[position] == 'X')
+    {
+        ++position;
+    }
+    else
+    {
+        while (position < name.size() && name[position] != '@' && name[position] != 'Z')
+        {
+            if (!skip_mangled_type(name, position, depth))
+            {
+                return false;
+            }
+        }
+
+        if (position < name.size() && name[position] == '@')
+        {
+            ++position;
+        }
+    }
+
+    if (position >= name.size() || name[position] != 'Z')
+    {
+        return false;
+    }
+
+    ++position;
+    return true;
+}
+
+static bool skip_mangled_type(std::string_view name, size_t & position, uint32_t depth)
+{
+    char code;
+
+    if (position >= name.size() || depth > max_mangled_depth)
+    {
+        return false;
+    }
+
+    code = name[position++];
+    switch (code)
+    {
+        /* Back references and basic types */
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+        case 'C': case 'D': case 'E': case 'F': case 'G': case 'H': case 'I': case 'J': case 'K': case 'M': case 'N': case 'O': case 'X':
+            return true;
+
+        case '_':
+            if (position >= name.size())
+            {
+                return false;
+            }
+            ++position;
+            return true;
+
+        /* References and pointers: 64-bit, unaligned and restrict
+         * modifiers, then the pointee qualifiers and type, or a function */
+        case 'A': case 'B': case 'P': case 'Q': case 'R': case 'S':
+            while (position < name.size() && (name[position] == 'E' || name[position] == 'F' || name[position] == 'I'))
+            {
+                ++position;
+            }
+            if (position < name.size() && name[position] == '6')
+            {
+                ++position;
+                return skip_mangled_function_type(name, position, depth + 1);
+            }
+            if (position >= name.size() || name[position] < 'A' || name[position] > 'D')
+            {
+                return false;
+            }
+            ++position;
+            return skip_mangled_type(name, position, depth + 1);
+
+        /* Unions, structures, classes, then enumerations */
+        case 'T': case 'U': case 'V':
+            return skip_mangled_qualified_name(name, position, depth + 1);
+
+        case 'W':
+            if (position >= name.size())
+            {
+                return false;
+            }
+            ++position;
+            return skip_mangled_qualified_name(name, position, depth + 1);
+
+        case '$':
+            /* Integer constant */
+            if (name.compare(position, 1, "0") == 0)
+            {
+                ++position;
+                return skip_mangled_number(name, position);
+            }
+            /* Rvalue references and qualified types */
+            if (name.compare(position, 2, "$Q") == 0 || name.compare(position, 2, "$R") == 0 || name.compare(position, 2, "$C") == 0)
+            {
+                position += 2;
+                while (position < name.size() && (name[position] == 'E' || name[position] == 'F' || name[position] == 'I'))
+                {
+                    ++position;
+                }
+                if (position >= name.size() || name[position] < 'A' || name[position] > 'D')
+                {
+                    return false;
+                }
+                ++position;
+                return skip_mangled_type(name, position, depth + 1);
+            }
+            /* nullptr_t, and empty parameter packs */
+            if (name.compare(position, 2, "$T") == 0 || name.compare(position, 2, "$V") == 0 || name.compare(position, 2, "$Z") == 0)
+            {
+                position += 2;
+                return true;
+            }
+            return false;
+
+        default:
+            return false;
+    }
+}
+
+/* Fragments of the qualified name of a symbol, back references resolved:
+ * its own name first, then its scopes from the innermost. Special names
+ * (constructors, operators, virtual tables...) have no own name */
+struct qualified_name_t
+{
+    bool parsed;
+    /* Index of the first scope */
+    uint32_t scopes;
+    std::vector<std::string_view> fragments;
+};
+
+static void parse_qualified_name(std::string_view name, qualified_name_t & qualified)
+{
+    std::string_view remembered[10];
+    uint32_t remembered_count = 0;
+    std::string_view fragment;
+    size_t position = 1;
+
+    qualified.parsed = false;
+    qualified.scopes = 1;
+    qualified.fragments.clear();
+    if (name.size() < 2 || name[0] != '?')
+    {
+        return;
+    }
+
+    /* ??<code>, but for function templates, ??$name@ */
+    if (name[1] == '?' && name.compare(1, 2, "?$") != 0)
+    {
+        position = 2;
+        if (name.compare(position, 2, "__") == 0)
+        {
+            position += 3;
+        }
+        else if (name.compare(position, 2, "_R") == 0)
+        {
+            position += 3;
+        }
+        else if (name.compare(position, 1, "_") == 0)
+        {
+            position += 2;
+        }
+        else
+        {
+            ++position;
+        }
+
+        /* String literals have no scope */
+        if (name.compare(2, 2, "_C") == 0 || position > name.size())
+        {
+            return;
+        }
+
+        /* RTTI type descriptors are of a type, base class descriptors start with their offsets */
+        if (name.compare(2, 3, "_R0") == 0)
+        {
+            if (name.compare(position, 3, "?AV") != 0 && name.compare(position, 3, "?AU") != 0)
+            {
+                return;
+            }
+            position += 3;
+        }
+        else if (name.compare(2, 3, "_R1") == 0)
+        {
+            for (uint32_t number = 0; number < 4; ++number)
+            {
+                if (!skip_mangled_number(name, position))
+                {
+                    return;
+                }
+            }
+        }
+
+        /* Dynamic initializers and destructors are of a variable, which
+         * isn't a scope */
+        if (name.compare(2, 3, "__E") != 0 && name.compare(2, 3, "__F") != 0)
+        {
+            qualified.scopes = 0;
+        }
+    }
+
+    while (position < name.size() && name[position] != '@')
+    {
+        if (!read_mangled_fragment(name, position, &fragment, 0))
+        {
+            return;
+        }
+
+        if (fragment[0] >= '0' && fragment[0] <= '9')
+        {
+            if ((uint32_t)(fragment[0] - '0') >= remembered_count)
+            {
+                return;
+            }
+            fragment = remembered[fragment[0] - '0'];
+        }
+        else if (remembered_count < 10)
+        {
+            remembered[remembered_count++] = fragment;
+        }
+
+        qualified.fragments.push_back(fragment);
+    }
+
+    qualified.parsed = (position < name.size() && qualified.fragments.size() >= qualified.scopes);
+}
+
+/* Template name of a template fragment, ?$name@... */
+static std::string_view fragment_template(std::string_view fragment)
+{
+    if (fragment.compare(0, 2, "?$") != 0)
+    {
+        return std::string_view();
+    }
+
+    return fragment.substr(2, fragment.find('@') - 2);
+}
+
+/* Scopes of a mangled name, "?name@inner@outer@@..." has "inner@outer",
+ * and "??0name@inner@@..." has "name@inner": a constructor is in its class.
+ * Empty for global names. When the scopes aren't as they appear in the name
+ * (back references), they are rebuilt in keys, which keeps them. Names that
+ * couldn't be parsed have their scopes up to the first "@@", or when they
+ * hold templates, whose arguments can't be told from scopes, the outermost
+ * scope alone */
+static std::string_view name_scopes(std::string_view name, qualified_name_t const & qualified, std::unordered_set<std::string> & keys)
+{
+    std::vector<std::string_view> const & fragments = qualified.fragments;
+    std::string key;
+    uint32_t fragment;
+    size_t begin;
+    size_t end;
+    size_t last;
+
+    if (!qualified.parsed)
+    {
+        if (name.size() < 2 || name[0] != '?' || name[1] == '?')
+        {
+            return std::string_view();
+        }
+
+        end = name.find("@@");
+        begin = name.find('@');
+        if (end == std::string_view::npos || begin == end)
+        {
+            return std::string_view();
+        }
+
+        ++begin;
+        if (name.substr(0, end).find("?$") != std::string_view::npos)
+        {
+            last = name.rfind('@', end - 1);
+            begin = (last == std::string_view::npos || last < begin ? begin : last + 1);
+        }
+
+        return name.substr(begin, end - begin);
+    }
+
+    if (qualified.scopes == fragments.size())
+    {
+        return std::string_view();
+    }
+
+    /* Contiguous in the name, as long as no back reference moved them.
+     * Names are followed by their '@', templates end with it */
+    begin = fragments[qualified.scopes].data() - name.data();
+    end = begin;
+    for (fragment = qualified.scopes; fragment < fragments.size(); ++fragment)
+    {
+        if (fragments[fragment].data() != name.data() + end)
+        {
+            break;
+        }
+
+        end += fragments[fragment].size();
+        if (fragment + 1 < fragments.size() && fragment_template(fragments[fragment]).empty())
+        {
+            ++end;
+        }
+    }
+
+    if (fragment == fragments.size())
+    {
+        return name.substr(begin, end - begin);
+    }
+
+    for (fragment = qualified.scopes; fragment < fragments.size(); ++fragment)
+    {
+        key.append(fragments[fragment]);
+        if (fragment + 1 < fragments.size() && fragment_template(fragments[fragment]).empty())
+        {
+            key += '@';
+        }
+    }
+
+    return *keys.insert(key).first;
+}
+
+/* Templates a symbol is in, or is: "?size@?$vector@H@std@@..." is in
+ * vector, "??$make@H@@..." is make. Its template arguments and signature
+ * don't count. Names that couldn't be parsed have the first template of
+ * their scopes */
+static void name_templates(std::string_view name, qualified_name_t const & qualified, std::vector<std::string_view> & templates)
+{
+    size_t begin;
+    size_t end;
+
+    templates.clear();
+    if (qualified.parsed)
+    {
+        for (std::vector<std::string_view>::const_iterator fragment = qualified.fragments.begin(); fragment != qualified.fragments.end(); ++fragment)
+        {
+            std::string_view found = fragment_template(*fragment);
+
+            if (!found.empty() && std::find(templates.begin(), templates.end(), found) == templates.end())
+            {
+                templates.push_back(found);
+            }
+        }
+
+        return;
+    }
+
+    /* Special names, such as string literals, aren't looked into */
+    end = name.find("@@");
+    begin = name.substr(0, end).find("?$");
+    if (name.size() < 2 || name[0] != '?' || (name[1] == '?' && begin != 1) || begin == std::string_view::npos)
+    {
+        return;
+    }
+
+    begin += 2;
+    templates.push_back(name.substr(begin, name.find('@', begin) - begin));
+}
+
+/* Outer scopes first, as in C++. Templates get <>, their arguments aren't
+ * told */
+static std::string scopes_name(std::string_view scopes)
+{
+    std::vector<std::string_view> fragments;
+    std::string_view fragment;
+    std::string name;
+    size_t position = 0;
+
+    if (scopes.empty())
+    {
+        return "(global)";
+    }
+
+    while (position < scopes.size())
+    {
+        if (!read_mangled_fragment(scopes, position, &fragment, 0))
+        {
+            return std::string(scopes);
+        }
+
+        fragments.push_back(fragment);
+    }
+
+    for (std::vector<std::string_view>::const_reverse_iterator it = fragments.rbegin(); it != fragments.rend(); ++it)
+    {
+        if (!name.empty())
+        {
+            name.append("::");
+        }
+
+        if (!fragment_template(*it).empty())
+        {
+            name.append(fragment_template(*it));
+            name.append("<>");
+        }
+        else if (it->compare(0, 2, "?A") == 0)
+        {
+            name.append("`anonymous namespace'");
+        }
+        else
+        {
+            name.append(*it);
+        }
+    }
+
+    return name;
+}
+
+/* The top largest, then how many were left out */
+template <typename name_t>
+static void print_largest(std::ostream & out, char const * const what, std::vector<std::pair<uint64_t, name_t> > & sizes, uint32_t top)
+{
+    uint64_t total = 0;
+    uint64_t others = 0;
+    uint32_t shown = std::min<uint64_t>(top, sizes.size());
+    uint32_t item;
+
+    for (item = 0; item < sizes.size(); ++item)
+    {
+        total += sizes[item].first;
+    }
+
+    std::partial_sort(sizes.begin(), sizes.begin() + shown, sizes.end(), [](std::pair<uint64_t, name_t> const & first, std::pair<uint64_t, name_t> const & second)
+    {
+        if (first.first != second.first)
+        {
+            return first.first > second.first;
+        }
+
+        return first.second < second.second;
+    });
+
+    out << what << ": " << sizes.size() << ", " << total << " bytes" << std::endl;
+    for (item = 0; item < sizes.size(); ++item)
+    {
+        if (item < shown)
+        {
+            out << diff_format("%12" PRIu64 " %5.1f%%  ", sizes[item].first, total == 0 ? 0.0 : sizes[item].first * 100.0 / total) << sizes[item].second << std::endl;
+        }
+        else
+        {
+            others += sizes[item].first;
+        }
+    }
+
+    if (shown < sizes.size())
+    {
+        out << diff_format("%12" PRIu64 " %5.1f%%  (%u others)", others, total == 0 ? 0.0 : others * 100.0 / total, (uint32_t)(sizes.size() - shown)) << std::endl;
+    }
+}
+
+/* Symbols span up to the next one of their segment, within the section
+ * contribution holding them: the last symbol of a contribution ends with
+ * it, the last one of a segment outside of any has no size */
+static void sum_symbol_sizes(std::vector<sized_symbol_t> & symbols, uint32_t begin, uint32_t end, std::vector<section_contribution_t> const & contributions, size_totals_t & totals)
+{
+    qualified_name_t qualified;
+    std::vector<std::string_view> templates;
+    uint32_t symbol;
+
+    totals.unattributed = 0;
+    for (symbol = begin; symbol < end; ++symbol)
+    {
+        sized_symbol_t & sized = symbols[symbol];
+        uint16_t segment = sized.address >> 32;
+        uint32_t offset = (uint32_t)sized.address;
+        uint64_t limit = 0;
+        uint32_t module = no_module;
+        std::vector<section_contribution_t>::const_iterator contribution;
+
+        if (symbol + 1 < symbols.size() && (symbols[symbol + 1].address >> 32) == segment)
+        {
+            limit = (uint32_t)symbols[symbol + 1].address;
+        }
+
+        contribution = std::upper_bound(contributions.begin(), contributions.end(), std::make_pair(segment, offset),
+                                        [](std::pair<uint16_t, uint32_t> const & address, section_contribution_t const & other)
+                                        {
+                                            return address.first != other.section ? address.first < other.section : address.second < other.offset;
+                                        });
+        if (contribution != contributions.begin())
+        {
+            --contribution;
+            if (contribution->section == segment && offset - contribution->offset < contribution->size)
+            {
+                module = contribution->module_index;
+                if (limit == 0 || limit > (uint64_t)contribution->offset + contribution->size)
+                {
+                    limit = (uint64_t)contribution->offset + contribution->size;
+                }
+            }
+        }
+
+        sized.size = (limit > offset ? limit - offset : 0);
+        if (module == no_module)
+        {
+            totals.unattributed += sized.size;
+        }
+        else
+        {
+            if (module >= totals.modules.size())
+            {
+                totals.modules.resize(module + 1, 0);
+            }
+            totals.modules[module] += sized.size;
+        }
+
+        parse_qualified_name(sized.name, qualified);
+        totals.namespaces[name_scopes(sized.name, qualified, totals.keys)] += sized.size;
+        name_templates(sized.name, qualified, templates);
+        for (std::vector<std::string_view>::const_iterator found = templates.begin(); found != templates.end(); ++found)
+        {
+            totals.templates[*found] += sized.size;
+        }
+    }
+}
+
+int report_sizes(char const * const pdb_file, pdb_options_t const & options, uint32_t top, std::ostream & out, std::ostream & err)
+{
+    pdb_file_t file(pdb_file, options, out, err);
+    symbols_view_t symbols_records;
+    modules_view_t modules_records;
+    std::vector<sized_symbol_t> symbols;
+    std::vector<section_contribution_t> contributions;
+    std::vector<module_t> modules;
+    std::map<uint16_t, uint64_t> sections;
+    std::vector<uint64_t> module_sizes;
+    std::vector<size_totals_t> totals;
+    std::vector<std::thread> workers;
+    std::vector<std::pair<uint64_t, std::string> > sizes;
+    std::vector<std::pair<uint64_t, std::string_view> > symbol_sizes;
+    std::unordered_map<std::string, uint64_t> scopes;
+    uint32_t jobs;
+    uint32_t job;
+    uint32_t item;
+
+    if (file.open() == -1)
+    {
+        return -1;
+    }
+
+    /* Names point into it */
+    symbols_records = file.symbols();
+    for (symbol_t const & symbol : symbols_records)
+    {
+        sized_symbol_t sized;
+
+        sized.address = ((uint64_t)symbol.segment << 32) | symbol.offset;
+        sized.name = symbol.name;
+        sized.size = 0;
+        symbols.push_back(sized);
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [](sized_symbol_t const & first, sized_symbol_t const & second) { return first.address < second.address; });
+
+    modules_records = file.modules();
+    for (module_t const & module : modules_records)
+    {
+        modules.push_back(module);
+    }
+
+    for (section_contribution_t const & contribution : file.section_contributions())
+    {
+        contributions.push_back(contribution);
+    }
+
+    /* Without section contributions, modules still have their first one */
+    if (contributions.empty())
+    {
+        for (std::vector<module_t>::const_iterator module = modules.begin(); module != modules.end(); ++module)
+        {
+            section_contribution_t contribution;
+
+            memset(&contribution, 0, sizeof(contribution));
+            contribution.section = module->section;
+            contribution.offset = module->offset;
+            contribution.size = module->size;
+            contribution.module_index = module->index;
+            contributions.push_back(contribution);
+        }
+    }
+
+    module_sizes.resize(modules.size(), 0);
+    for (std::vector<section_contribution_t>::const_iterator contribution = contributions.begin(); contribution != contributions.end(); ++contribution)
+    {
+        sections[contribution->section] += contribution->size;
+        if (contribution->module_index < module_sizes.size())
+        {
+            module_sizes[contribution->module_index] += contribution->size;
+        }
+    }
+
+    std::sort(contributions.begin(), contributions.end(), [](section_contribution_t const & first, section_contribution_t const & second)
+    {
+        return first.section != second.section ? first.section < second.section : first.offset < second.offset;
+    });
+
+    /* Symbols are split among jobs, whose totals are merged after */
+    jobs = std::max<uint32_t>(1, std::min<uint64_t>(options.jobs, symbols.size() / 0x10000 + 1));
+    totals.resize(jobs);
+    for (job = 1; job < jobs; ++job)
+    {
+        workers.push_back(std::thread([&, job]()
+        {
+            sum_symbol_sizes(symbols, (uint64_t)symbols.size() * job / jobs, (uint64_t)symbols.size() * (job + 1) / jobs, contributions, totals[job]);
+        }));
+    }
+
+    sum_symbol_sizes(symbols, 0, symbols.size() / jobs, contributions, totals[0]);
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+        it->join();
+    }
+
+    for (job = 1; job < jobs; ++job)
+    {
+        for (std::unordered_map<std::string_view, uint64_t>::const_iterator it = totals[job].namespaces.begin(); it != totals[job].namespaces.end(); ++it)
+        {
+            totals[0].namespaces[it->first] += it->second;
+        }
+        for (std::unordered_map<std::string_view, uint64_t>::const_iterator it = totals[job].templates.begin(); it != totals[job].templates.end(); ++it)
+        {
+            totals[0].templates[it->first] += it->second;
+        }
+        if (totals[job].modules.size() > totals[0].modules.size())
+        {
+            totals[0].modules.resize(totals[job].modules.size(), 0);
+        }
+        for (item = 0; item < totals[job].modules.size(); ++item)
+        {
+            totals[0].modules[item] += totals[job].modules[item];
+        }
+        totals[0].unattributed += totals[job].unattributed;
+    }
+
+    out << "Sizes of " << pdb_file << std::endl;
+
+    for (std::map<uint16_t, uint64_t>::const_iterator section = sections.begin(); section != sections.end(); ++section)
+    {
+        sizes.push_back(std::make_pair(section->second, diff_format("section %u", section->first)));
+    }
+    print_largest(out, "Sections", sizes, sections.size());
+
+    sizes.clear();
+    for (std::vector<module_t>::const_iterator module = modules.begin(); module != modules.end(); ++module)
+    {
+        uint64_t symbols_size = module->index < totals[0].modules.size() ? totals[0].modules[module->index] : 0;
+
+        sizes.push_back(std::make_pair(module_sizes[module->index], std::string(module->name) + " (" + std::string(module->object_name) + "), " +
+                                       diff_format("%" PRIu64 " bytes of symbols", symbols_size)));
+    }
+    print_largest(out, "Modules", sizes, top);
+
+    /* Scopes differing by template arguments only are shown as one */
+    for (std::unordered_map<std::string_view, uint64_t>::const_iterator it = totals[0].namespaces.begin(); it != totals[0].namespaces.end(); ++it)
+    {
+        scopes[scopes_name(it->first)] += it->second;
+    }
+
+    sizes.clear();
+    for (std::unordered_map<std::string, uint64_t>::const_iterator it = scopes.begin(); it != scopes.end(); ++it)
+    {
+        sizes.push_back(std::make_pair(it->second, it->first));
+    }
+    print_largest(out, "Namespaces", sizes, top);
+
+    sizes.clear();
+    for (std::unordered_map<std::string_view, uint64_t>::const_iterator it = totals[0].templates.begin(); it != totals[0].templates.end(); ++it)
+    {
+        sizes.push_back(std::make_pair(it->second, std::string(it->first) + "<>"));
+    }
+    print_largest(out, "Templates", sizes, top);
+
+    for (std::vector<sized_symbol_t>::const_iterator symbol = symbols.begin(); symbol != symbols.end(); ++symbol)
+    {
+        symbol_sizes.push_back(std::make_pair((uint64_t)symbol->size, symbol->name));
+    }
+    print_largest(out, "Symbols", symbol_sizes, top);
+
+    out << "Symbols outside of section contributions: " << totals[0].unattributed << " bytes" << std::endl;
+    return 0;
+}
+
+void print_stats(std::ostream & err)
+{
+    buffer_pool_stats_t pool = buffer_pool_t::totals();
+    phase_stats_t phases[phases_count];
+    io_stats_t directory;
+    io_stats_t kinds[stream_kinds_count];
+    struct rusage usage;
+    uint32_t kind;
+
+    err << "Buffer pool: " << pool.requests << " requests, " << pool.reuses << " reused, "
+              << pool.heap_allocations << " heap allocations, " << pool.heap_frees << " heap frees, "
+              << pool.cached_bytes << "B cached" << std::endl;
+
+    phase_scope_t::totals(phases);
+    print_phases(err, phases);
+
+    /* Only the process peak is known, phases of all the threads share it. In KB on Linux */
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        err << "Peak RSS: " << usage.ru_maxrss << "KB" << std::endl;
+    }
+
+    pdb_io_t::totals(&directory, kinds);
+    print_io_header(err);
+    print_io_stats(err, "directory", directory);
+    for (kind = 0; kind < stream_kinds_count; ++kind)
+    {
+        print_io_stats(err, stream_kind_names[kind], kinds[kind]);
+    }
+}
@@ -0,0 +1,1970 @@
+/*
+* pdb_view - A library for reading PDB files
+* Copyright (C) 2015 Pierre Schweitzer <pierre@reactos.org>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Declares the PDB structures, pdb_file_t which dumps and queries a PDB
+* file, and what it is built on.
+*/
+
+#ifndef PDB_VIEW_H
+#define PDB_VIEW_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <iterator>
+#include <cstddef>
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
+#include <string>
+#include <iostream>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+#include <type_traits>
+
+#define PDB_SIGNATURE_200 "Microsoft C/C++ program database 2.00\r\n\x1AJG\0"
+#define PDB_SIGNATURE_200_SIZE sizeof(PDB_SIGNATURE_200)
+
+struct __attribute__((__packed__)) pdb_stream_t
+{
+    uint32_t stream_size;
+    uint16_t stream_page[2];
+};
+
+struct __attribute__((__packed__)) pdb_header_t
+{
+    uint32_t page_size;
+    uint16_t start_page;
+    uint16_t file_pages;
+    pdb_stream_t root_stream;
+};
+
+struct __attribute__((__packed__)) pdb_root_t
+{
+    uint16_t count;
+    uint16_t reserved;
+    pdb_stream_t streams[1];
+};
+
+typedef enum
+{
+    type_root_t = 0,
+    type_pdb_header_t,
+    type_tpi,
+    type_dbi,
+    type_fpo = 5,
+} stream_types_t;
+
+struct __attribute__((__packed__)) pdb_stream_header_t
+{
+    uint32_t version;
+    uint32_t signature;
+    uint32_t age;
+};
+
+struct __attribute__((__packed__)) guid_t
+{
+    uint32_t data1;
+    uint16_t data2;
+    uint16_t data3;
+    uint8_t data4[8];
+};
+
+struct __attribute__((__packed__)) pdb_stream_header_ex_t
+{
+    pdb_stream_header_t header;
+    guid_t guid;
+};
+
+typedef enum
+{
+    pdb_version_2 = 19941610,
+    pdb_version_4 = 19950623,
+    pdb_version_41 = 19950814,
+    pdb_version_5 = 19960307,
+    pdb_version_6 = 19970604,
+    pdb_version_7p = 19990604,
+    pdb_version_7 = 20000404,
+} pdb_versions_t;
+
+struct __attribute__((__packed__)) old_dbi_header_t
+{
+    uint16_t global_symbols_stream;
+    uint16_t private_symbols_stream;
+    uint16_t symbols_stream;
+};
+
+struct __attribute__((__packed__)) dbi_header_t
+{
+    uint32_t signature;
+    uint32_t version;
+    uint32_t age;
+    uint16_t global_symbols_stream;
+    uint16_t dll_version;
+    uint16_t private_symbols_stream;
+    uint16_t dll_build_number;
+    uint16_t symbols_stream;
+};
+
+/* Newer DBI streams go on with the sizes of their substreams, which follow
+ * in this order */
+struct __attribute__((__packed__)) dbi_header_ex_t
+{
+    dbi_header_t header;
+    uint16_t dll_rebuild_number;
+    uint32_t module_info_size;
+    uint32_t section_contribution_size;
+    uint32_t section_map_size;
+    uint32_t file_info_size;
+    uint32_t type_server_map_size;
+    uint32_t mfc_type_server_index;
+    uint32_t debug_header_size;
+    uint32_t ec_info_size;
+    uint16_t flags;
+    uint16_t machine;
+    uint32_t reserved;
+};
+
+struct __attribute__((__packed__)) section_contribution_t
+{
+    uint16_t section;
+    uint16_t padding1;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t characteristics;
+    uint16_t module_index;
+    uint16_t padding2;
+    uint32_t data_crc;
+    uint32_t reloc_crc;
+};
+
+/* Module info substream records, followed by the module and object names,
+ * NUL terminated, and aligned on 32-bit */
+struct __attribute__((__packed__)) module_info_t
+{
+    uint32_t reserved1;
+    section_contribution_t section_contribution;
+    uint16_t flags;
+    uint16_t symbols_stream;
+    uint32_t symbols_size;
+    uint32_t c11_lines_size;
+    uint32_t c13_lines_size;
+    uint16_t source_files;
+    uint16_t padding;
+    uint32_t reserved2;
+    uint32_t source_file_name;
+    uint32_t pdb_file_path_name;
+};
+
+/* Header layouts, by PDB version */
+typedef enum
+{
+    /* Up to 4.0: DBI header without signature nor version */
+    pdb_format_2 = 0,
+    /* DBI header with its version */
+    pdb_format_5,
+    /* After 7.0 previews: PDB header with a GUID */
+    pdb_format_7,
+    pdb_formats_count,
+} pdb_format_t;
+
+typedef enum
+{
+    section_contributions_version_60 = 0xEFFE0000 + 19970605,
+    /* Entries followed by the COFF section index */
+    section_contributions_version_2 = 0xEFFE0000 + 20140516,
+} section_contributions_versions_t;
+
+typedef enum
+{
+    dbi_version_41 = 930803,
+    dbi_version_5 = 19960307,
+    dbi_version_6 = 19970606,
+    dbi_version_7 = 19990903,
+} dbi_versions_t;
+
+struct __attribute__((__packed__)) tpi_header_t
+{
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t min_ti;
+    uint32_t max_ti;
+    uint32_t size;
+};
+
+typedef enum
+{
+    tpi_version_6 = 19961031,
+} tpi_versions_t;
+
+struct __attribute__((__packed__)) symbol_data_t
+{
+    uint16_t version;
+    uint32_t type;
+    uint32_t offset;
+    uint16_t segment;
+};
+
+typedef enum
+{
+    symbol_data_version_2 = 0x1009,
+    symbol_data_version_3 = 0x110E,
+}  symbol_data_version_t;
+
+/* Leaf kinds of type records */
+typedef enum
+{
+    type_leaf_modifier = 0x1001,
+    type_leaf_pointer = 0x1002,
+    type_leaf_procedure = 0x1008,
+    type_leaf_mfunction = 0x1009,
+    type_leaf_arglist = 0x1201,
+    type_leaf_fieldlist = 0x1203,
+    type_leaf_bitfield = 0x1205,
+    type_leaf_methodlist = 0x1206,
+    type_leaf_array = 0x1503,
+    type_leaf_class = 0x1504,
+    type_leaf_structure = 0x1505,
+    type_leaf_union = 0x1506,
+    type_leaf_enum = 0x1507,
+} type_leaf_t;
+
+/* Leaf kinds of field list members */
+typedef enum
+{
+    member_leaf_bclass = 0x1400,
+    member_leaf_vbclass = 0x1401,
+    member_leaf_ivbclass = 0x1402,
+    member_leaf_index = 0x1404,
+    member_leaf_vfunctab = 0x1409,
+    member_leaf_enumerate = 0x1502,
+    member_leaf_member = 0x150D,
+    member_leaf_stmember = 0x150E,
+    member_leaf_method = 0x150F,
+    member_leaf_nesttype = 0x1510,
+    member_leaf_onemethod = 0x1511,
+} member_leaf_t;
+
+/* Numeric leaves: values below numeric_leaf_char are stored as the leaf
+ * itself, others follow it */
+typedef enum
+{
+    numeric_leaf_char = 0x8000,
+    numeric_leaf_short = 0x8001,
+    numeric_leaf_ushort = 0x8002,
+    numeric_leaf_long = 0x8003,
+    numeric_leaf_ulong = 0x8004,
+    numeric_leaf_quadword = 0x8009,
+    numeric_leaf_uquadword = 0x800A,
+} numeric_leaf_t;
+
+/* Record visitors. A visitor handles the record kinds it cares about with
+ * overloads of operator(), as in
+ *
+ *     struct visitor_t
+ *     {
+ *         void operator()(record_kind_t<type_leaf_structure>, type_record_t const & record);
+ *     };
+ *
+ * The dispatch only compares against the kinds the visitor has a handler
+ * for, it is resolved at compile time. Type records of other kinds are
+ * skipped by their length. Symbol records have no length field, so the
+ * symbol walk (next_symbol_record()) stops at a record of unknown kind with
+ * record_walk_unsupported */
+template <uint16_t kind>
+struct record_kind_t
+{
+    static const uint16_t value = kind;
+};
+
+/* The kinds a walk dispatches on */
+template <uint16_t... kinds>
+struct record_kinds_t
+{
+};
+
+typedef record_kinds_t<symbol_data_version_2> symbol_kinds_t;
+typedef record_kinds_t<type_leaf_modifier, type_leaf_pointer, type_leaf_procedure, type_leaf_mfunction,
+                       type_leaf_arglist, type_leaf_fieldlist, type_leaf_bitfield, type_leaf_methodlist,
+                       type_leaf_array, type_leaf_class, type_leaf_structure, type_leaf_union, type_leaf_enum> type_leaf_kinds_t;
+
+/* A symbol record, and its name. Length covers the name and alignment */
+struct symbol_record_t
+{
+    symbol_data_t const * data;
+    std::string_view name;
+    uint32_t length;
+};
+
+/* A type record. Data follows the leaf kind, length covers the whole record */
+struct type_record_t
+{
+    uint32_t type_index;
+    uint16_t kind;
+    uint32_t length;
+    char const * data;
+};
+
+typedef enum
+{
+    record_walk_done = 0,
+    record_walk_unsupported,
+    record_walk_corrupted,
+} record_walk_t;
+
+template <uint16_t kind, typename visitor_t, typename record_t>
+inline bool visit_record_kind(visitor_t & visitor, uint16_t record_kind, record_t const & record)
+{
+    if constexpr (std::is_invocable_v<visitor_t &, record_kind_t<kind>, record_t const &>)
+    {
+        if (record_kind == kind)
+        {
+            visitor(record_kind_t<kind>(), record);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename visitor_t, typename record_t, uint16_t... kinds>
+inline void dispatch_record(visitor_t & visitor, uint16_t record_kind, record_t const & record, record_kinds_t<kinds...>)
+{
+    (visit_record_kind<kinds>(visitor, record_kind, record) || ...);
+}
+
+/* Symbol stream: a leading 16-bit word, then records aligned on 16-bit.
+ * Frames the record at buffer and moves past it; at the end of the stream,
+ * record data is null */
+inline record_walk_t next_symbol_record(char const ** const buffer, char const * const end_buffer, symbol_record_t * const record)
+{
+    char const * next = *buffer;
+    uint32_t padding;
+    uint8_t len;
+
+    record->data = 0;
+    if (next + sizeof(symbol_data_t) >= end_buffer)
+    {
+        return record_walk_done;
+    }
+
+    /* HACK, there appear to have weird padding in files */
+    for (padding = 0; ((symbol_data_t const *)next)->version != symbol_data_version_2; ++padding)
+    {
+        if (padding == 2)
+        {
+            return record_walk_unsupported;
+        }
+
+        next += sizeof(uint16_t);
+        if (next + sizeof(symbol_data_t) > end_buffer)
+        {
+            return record_walk_done;
+        }
+    }
+
+    record->data = (symbol_data_t const *)next;
+    next += sizeof(symbol_data_t);
+    if (next + sizeof(uint8_t) > end_buffer)
+    {
+        return record_walk_corrupted;
+    }
+
+    len = *(uint8_t const *)next;
+    next += sizeof(uint8_t);
+    if (next + len > end_buffer)
+    {
+        return record_walk_corrupted;
+    }
+
+    record->name = std::string_view(next, len);
+    next += len;
+    /* Jump to next entry must be aligned on uint16_t */
+    if (((uintptr_t)next & 1) != 0)
+    {
+        ++next;
+    }
+
+    record->length = next - (char const *)record->data;
+    *buffer = next;
+    return record_walk_done;
+}
+
+/* The stream is at least its leading word */
+template <typename visitor_t, typename kinds_t = symbol_kinds_t>
+inline record_walk_t walk_symbol_records(void const * const stream_buffer, uint32_t stream_size, visitor_t & visitor, kinds_t kinds = kinds_t())
+{
+    char const * buffer = (char const *)stream_buffer + sizeof(uint16_t);
+    char const * const end_buffer = (char const *)stream_buffer + stream_size;
+
+    for (;;)
+    {
+        symbol_record_t record;
+        record_walk_t walk;
+
+        walk = next_symbol_record(&buffer, end_buffer, &record);
+        if (walk != record_walk_done || record.data == 0)
+        {
+            return walk;
+        }
+
+        dispatch_record(visitor, record.data->version, record, kinds);
+    }
+}
+
+/* TPI stream: its header, then records that are a 16-bit length, not
+ * counting itself, and the leaf kind. Type indexes start at min_ti. The
+ * stream is at least the header */
+inline record_walk_t type_records_bounds(tpi_header_t const * const tpi_header, uint32_t stream_size, char const ** const begin, char const ** const end)
+{
+    if (tpi_header->header_size < sizeof(tpi_header_t) || tpi_header->size > stream_size - sizeof(tpi_header_t) ||
+        tpi_header->header_size > sizeof(tpi_header_t) + tpi_header->size)
+    {
+        return record_walk_corrupted;
+    }
+
+    *begin = (char const *)tpi_header + tpi_header->header_size;
+    *end = (char const *)tpi_header + sizeof(tpi_header_t) + tpi_header->size;
+    return record_walk_done;
+}
+
+/* As next_symbol_record(), data is null at the end */
+inline record_walk_t next_type_record(char const ** const record, char const * const end, type_record_t * const type)
+{
+    type->data = 0;
+    if (*record + 2 * sizeof(uint16_t) > end)
+    {
+        return record_walk_done;
+    }
+
+    type->length = *(uint16_t const *)*record;
+    if (type->length < sizeof(uint16_t) || *record + sizeof(uint16_t) + type->length > end)
+    {
+        return record_walk_corrupted;
+    }
+
+    type->length += sizeof(uint16_t);
+    type->kind = *(uint16_t const *)(*record + sizeof(uint16_t));
+    type->data = *record + 2 * sizeof(uint16_t);
+    *record += type->length;
+    return record_walk_done;
+}
+
+/* Walked records count is returned in records */
+template <typename visitor_t, typename kinds_t = type_leaf_kinds_t>
+inline record_walk_t walk_type_records(tpi_header_t const * const tpi_header, uint32_t stream_size, visitor_t & visitor, uint32_t * records, kinds_t kinds = kinds_t())
+{
+    char const * record;
+    char const * end;
+    record_walk_t walk;
+
+    *records = 0;
+    walk = type_records_bounds(tpi_header, stream_size, &record, &end);
+    if (walk != record_walk_done)
+    {
+        return walk;
+    }
+
+    for (;;)
+    {
+        type_record_t type;
+
+        walk = next_type_record(&record, end, &type);
+        if (walk != record_walk_done || type.data == 0)
+        {
+            return walk;
+        }
+
+        type.type_index = tpi_header->min_ti + *records;
+        dispatch_record(visitor, type.kind, type, kinds);
+        ++*records;
+    }
+}
+
+/* Size of the numeric leaf at data, 0 when unknown or past end */
+inline uint32_t numeric_leaf_size(char const * const data, char const * const end)
+{
+    uint32_t size;
+
+    if (data + sizeof(uint16_t) > end)
+    {
+        return 0;
+    }
+
+    switch (*(uint16_t const *)data)
+    {
+        case numeric_leaf_char:
+            size = sizeof(uint8_t);
+            break;
+
+        case numeric_leaf_short:
+        case numeric_leaf_ushort:
+            size = sizeof(uint16_t);
+            break;
+
+        case numeric_leaf_long:
+        case numeric_leaf_ulong:
+            size = sizeof(uint32_t);
+            break;
+
+        case numeric_leaf_quadword:
+        case numeric_leaf_uquadword:
+            size = sizeof(uint64_t);
+            break;
+
+        default:
+            size = 0;
+            if (*(uint16_t const *)data >= numeric_leaf_char)
+            {
+                return 0;
+            }
+            break;
+    }
+
+    size += sizeof(uint16_t);
+    return data + size > end ? 0 : size;
+}
+
+/* Moves past a NUL terminated name, null when it isn't */
+inline char const * skip_leaf_name(char const * const data, char const * const end)
+{
+    char const * name_end = (char const *)memchr(data, 0, end - data);
+
+    return name_end == 0 ? 0 : name_end + 1;
+}
+
+/* Members of a field list follow each other, padded on 32-bit with bytes of
+ * 0xF0 and over. Calls index() with the offset in data of each type index */
+template <typename index_t>
+inline bool field_list_indexes(char const * const data, char const * const end, index_t & index)
+{
+    char const * member = data;
+
+    while (member < end)
+    {
+        char const * next = member + sizeof(uint16_t);
+        uint32_t size;
+
+        if ((uint8_t)*member >= 0xF0)
+        {
+            ++member;
+            continue;
+        }
+
+        if (next > end)
+        {
+            return false;
+        }
+
+        switch (*(uint16_t const *)member)
+        {
+            /* Attributes, base class, offset */
+            case member_leaf_bclass:
+                if (next + sizeof(uint16_t) + sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                next += sizeof(uint16_t) + sizeof(uint32_t);
+                size = numeric_leaf_size(next, end);
+                if (size == 0)
+                {
+                    return false;
+                }
+                next += size;
+                break;
+
+            /* Attributes, base class, base pointer, two offsets */
+            case member_leaf_vbclass:
+            case member_leaf_ivbclass:
+                if (next + sizeof(uint16_t) + 2 * sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                index(next + sizeof(uint16_t) + sizeof(uint32_t) - data);
+                next += sizeof(uint16_t) + 2 * sizeof(uint32_t);
+                size = numeric_leaf_size(next, end);
+                if (size == 0 || numeric_leaf_size(next + size, end) == 0)
+                {
+                    return false;
+                }
+                next += size + numeric_leaf_size(next + size, end);
+                break;
+
+            /* Padding, continuation list or virtual table */
+            case member_leaf_index:
+            case member_leaf_vfunctab:
+                if (next + sizeof(uint16_t) + sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                next += sizeof(uint16_t) + sizeof(uint32_t);
+                break;
+
+            /* Attributes, value, name */
+            case member_leaf_enumerate:
+                size = numeric_leaf_size(next + sizeof(uint16_t), end);
+                if (size == 0)
+                {
+                    return false;
+                }
+                next = skip_leaf_name(next + sizeof(uint16_t) + size, end);
+                break;
+
+            /* Attributes, type, offset, name */
+            case member_leaf_member:
+                if (next + sizeof(uint16_t) + sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                next += sizeof(uint16_t) + sizeof(uint32_t);
+                size = numeric_leaf_size(next, end);
+                if (size == 0)
+                {
+                    return false;
+                }
+                next = skip_leaf_name(next + size, end);
+                break;
+
+            /* Attributes, count or padding, then a type or method list, name */
+            case member_leaf_stmember:
+            case member_leaf_method:
+            case member_leaf_nesttype:
+                if (next + sizeof(uint16_t) + sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                next = skip_leaf_name(next + sizeof(uint16_t) + sizeof(uint32_t), end);
+                break;
+
+            /* Attributes, type, virtual table offset of introducing methods, name */
+            case member_leaf_onemethod:
+                if (next + sizeof(uint16_t) + sizeof(uint32_t) > end)
+                {
+                    return false;
+                }
+                index(next + sizeof(uint16_t) - data);
+                size = sizeof(uint16_t) + sizeof(uint32_t);
+                if (((*(uint16_t const *)next >> 2) & 7) == 4 || ((*(uint16_t const *)next >> 2) & 7) == 6)
+                {
+                    size += sizeof(uint32_t);
+                }
+                next = next + size > end ? 0 : skip_leaf_name(next + size, end);
+                break;
+
+            default:
+                return false;
+        }
+
+        if (next == 0 || next > end)
+        {
+            return false;
+        }
+
+        member = next;
+    }
+
+    return true;
+}
+
+/* Calls index() with the offset in the record data of each type index the
+ * record references. False for leaf kinds whose layout isn't known, or
+ * corrupted records */
+template <typename index_t>
+inline bool type_record_indexes(type_record_t const & type, index_t index)
+{
+    uint32_t const size = type.length - 2 * sizeof(uint16_t);
+    uint32_t offset;
+    uint32_t count;
+
+    switch (type.kind)
+    {
+        /* Modified type or underlying type, then attributes */
+        case type_leaf_modifier:
+        case type_leaf_bitfield:
+            if (size < sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(0);
+            return true;
+
+        /* Pointed type, attributes, and the class of pointers to members */
+        case type_leaf_pointer:
+            if (size < 2 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(0);
+            count = (*(uint32_t const *)(type.data + sizeof(uint32_t)) >> 5) & 7;
+            if (count == 2 || count == 3)
+            {
+                if (size < 3 * sizeof(uint32_t))
+                {
+                    return false;
+                }
+                index(2 * sizeof(uint32_t));
+            }
+            return true;
+
+        /* Return type, calling convention, attributes, parameters count, arguments list */
+        case type_leaf_procedure:
+            if (size < 3 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(0);
+            index(2 * sizeof(uint32_t));
+            return true;
+
+        /* Return, class and this types, then as procedures */
+        case type_leaf_mfunction:
+            if (size < 5 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(0);
+            index(sizeof(uint32_t));
+            index(2 * sizeof(uint32_t));
+            index(4 * sizeof(uint32_t));
+            return true;
+
+        case type_leaf_arglist:
+            if (size < sizeof(uint32_t))
+            {
+                return false;
+            }
+            count = *(uint32_t const *)type.data;
+            if (count > (size - sizeof(uint32_t)) / sizeof(uint32_t))
+            {
+                return false;
+            }
+            for (offset = 0; offset < count; ++offset)
+            {
+                index(sizeof(uint32_t) + offset * sizeof(uint32_t));
+            }
+            return true;
+
+        case type_leaf_fieldlist:
+            return field_list_indexes(type.data, type.data + size, index);
+
+        /* Attributes, padding, type, virtual table offset of introducing methods */
+        case type_leaf_methodlist:
+            for (offset = 0; offset < size; )
+            {
+                if (offset + 2 * sizeof(uint16_t) + sizeof(uint32_t) > size)
+                {
+                    return false;
+                }
+                count = (*(uint16_t const *)(type.data + offset) >> 2) & 7;
+                index(offset + 2 * sizeof(uint16_t));
+                offset += 2 * sizeof(uint16_t) + sizeof(uint32_t) + (count == 4 || count == 6 ? sizeof(uint32_t) : 0);
+            }
+            return offset == size;
+
+        /* Element and index types, size, name */
+        case type_leaf_array:
+            if (size < 2 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(0);
+            index(sizeof(uint32_t));
+            return true;
+
+        /* Members count, properties, field list, derived classes, virtual table shape, size, name */
+        case type_leaf_class:
+        case type_leaf_structure:
+            if (size < 2 * sizeof(uint16_t) + 3 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(2 * sizeof(uint16_t));
+            index(2 * sizeof(uint16_t) + sizeof(uint32_t));
+            index(2 * sizeof(uint16_t) + 2 * sizeof(uint32_t));
+            return true;
+
+        /* Members count, properties, field list, size, name */
+        case type_leaf_union:
+            if (size < 2 * sizeof(uint16_t) + sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(2 * sizeof(uint16_t));
+            return true;
+
+        /* Members count, properties, underlying type, field list, name */
+        case type_leaf_enum:
+            if (size < 2 * sizeof(uint16_t) + 2 * sizeof(uint32_t))
+            {
+                return false;
+            }
+            index(2 * sizeof(uint16_t));
+            index(2 * sizeof(uint16_t) + sizeof(uint32_t));
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/* Global type hashes, as GHASH: a type record hashes its kind and data, with
+ * the type indexes it references replaced by their own hashes, so that a
+ * type hashes the same in any file, whatever its index there. Records whose
+ * layout isn't known, or that reference types after them, can't be hashed
+ * so: they are hashed with their file's records, so that they only match
+ * in identical type streams */
+typedef uint64_t type_hash_t;
+
+/* 64-bit hash of bytes, the same on every run (MurmurHash64A) */
+uint64_t hash_bytes(void const * const data, size_t size, uint64_t seed);
+/* Hash of each record of a TPI stream in memory, in type index order. The
+ * stream is at least the header */
+record_walk_t hash_type_records(tpi_header_t const * const tpi_header, uint32_t stream_size, std::vector<type_hash_t> & hashes);
+
+/* Types of several files, deduplicated on their global hash. Types get new
+ * indexes in the store, from min_ti on, and the type indexes in their
+ * records are rewritten to them */
+class type_store_t
+{
+public:
+    static const uint32_t min_ti = 0x1000;
+
+    /* Adds the records of a TPI stream, whose hashes are given. The index in
+     * the store of each of them is returned in indexes; how many were new */
+    uint32_t add(tpi_header_t const * const tpi_header, uint32_t stream_size, std::vector<type_hash_t> const & hashes, std::vector<uint32_t> & indexes);
+    uint32_t types_count() const { return _offsets.size(); }
+    type_record_t type(uint32_t type_index) const;
+    type_hash_t hash(uint32_t type_index) const { return _hashes[type_index - min_ti]; }
+    /* Index of a type in the store, 0 when it has none such */
+    uint32_t find(type_hash_t hash) const;
+    /* The store as a TPI stream */
+    void tpi_stream(std::vector<char> & stream) const;
+
+private:
+    std::unordered_map<type_hash_t, uint32_t> _indexes;
+    /* As in a TPI stream */
+    std::vector<char> _records;
+    std::vector<uint32_t> _offsets;
+    std::vector<type_hash_t> _hashes;
+};
+
+/* A module, and its first section contribution */
+struct module_t
+{
+    uint32_t index;
+    std::string_view name;
+    std::string_view object_name;
+    uint16_t symbols_stream;
+    uint32_t symbols_size;
+    uint16_t section;
+    uint32_t offset;
+    uint32_t size;
+};
+
+/* Module info substream, from begin to end. As next_symbol_record(), name
+ * data is null at the end */
+inline record_walk_t next_module(char const ** const record, char const * const begin, char const * const end, module_t * const module)
+{
+    module_info_t const * info = (module_info_t const *)*record;
+    char const * name;
+    char const * object_name;
+    char const * next;
+
+    module->name = std::string_view();
+    if (*record + sizeof(module_info_t) > end)
+    {
+        return *record == end ? record_walk_done : record_walk_corrupted;
+    }
+
+    name = *record + sizeof(module_info_t);
+    object_name = (char const *)memchr(name, 0, end - name);
+    if (object_name == 0)
+    {
+        return record_walk_corrupted;
+    }
+
+    ++object_name;
+    next = (char const *)memchr(object_name, 0, end - object_name);
+    if (next == 0)
+    {
+        return record_walk_corrupted;
+    }
+
+    module->name = std::string_view(name, object_name - 1 - name);
+    module->object_name = std::string_view(object_name, next - object_name);
+    module->symbols_stream = info->symbols_stream;
+    module->symbols_size = info->symbols_size;
+    module->section = info->section_contribution.section;
+    module->offset = info->section_contribution.offset;
+    module->size = info->section_contribution.size;
+
+    next += 1 + (4 - (next + 1 - begin) % 4) % 4;
+    *record = std::min(next, end);
+    return record_walk_done;
+}
+
+/* What a stream is decoded as */
+typedef enum
+{
+    stream_kind_root = 0,
+    stream_kind_pdb_header,
+    stream_kind_tpi,
+    stream_kind_dbi,
+    stream_kind_fpo,
+    stream_kind_gs,
+    stream_kind_ps,
+    stream_kind_sym,
+    stream_kind_unknown,
+    stream_kinds_count,
+} stream_kind_t;
+
+static char const * const stream_kind_names[stream_kinds_count] = { "root", "pdb_header", "tpi", "dbi", "fpo", "gs", "ps", "sym", "unknown" };
+
+/* How the file is read */
+typedef enum
+{
+    io_backend_stdio = 0,
+    io_backend_pread,
+    io_backend_mmap,
+    io_backends_count,
+} io_backend_t;
+
+static char const * const io_backend_names[io_backends_count] = { "stdio", "pread", "mmap" };
+
+struct pdb_options_t
+{
+    pdb_options_t();
+
+    bool stats;
+    /* Also print each file's phases */
+    bool stats_files;
+    /* Memory allowed for building indexes, 0 for no limit */
+    uint64_t memory_budget;
+    bool compress_index;
+    io_backend_t io_backend;
+    /* Files processed at once */
+    uint32_t jobs;
+    /* Streams of a file fetched at once */
+    uint32_t stream_jobs;
+    std::vector<std::pair<uint16_t, uint32_t> > lookups;
+    std::vector<std::string> prefixes;
+    /* Print records histograms of the symbol and type streams */
+    bool histograms;
+};
+
+/* Steps of an extraction, as accounted by --stats. Streams are fetched and
+ * decoded per stream kind, unless they were all fetched at once beforehand */
+typedef enum
+{
+    phase_header = 0,
+    phase_root,
+    phase_prefetch,
+    phase_fetch,
+    phase_decode = phase_fetch + stream_kinds_count,
+    phase_index = phase_decode + stream_kinds_count,
+    phase_output,
+    phases_count,
+} phase_t;
+
+/* Hardware counters read around phases (--perf-counters) */
+typedef enum
+{
+    perf_cycles = 0,
+    perf_instructions,
+    perf_cache_misses,
+    perf_branch_misses,
+    perf_counters_count,
+} perf_counter_t;
+
+static char const * const perf_counter_names[perf_counters_count] = { "cycles", "instructions", "cache misses", "branch misses" };
+
+struct phase_stats_t
+{
+    phase_stats_t();
+
+    void add(phase_stats_t const & stats);
+
+    uint64_t count;
+    /* Monotonic clock time spent in the phase */
+    uint64_t elapsed_ns;
+    /* Heap bytes allocated during the phase */
+    uint64_t allocated_bytes;
+    /* Highest heap usage reached during the phase, over the usage when it started */
+    uint64_t peak_heap_bytes;
+    /* Phases the hardware counters were read around, and their sums */
+    uint64_t perf_count;
+    uint64_t perf_values[perf_counters_count];
+};
+
+/* Hardware counters of the calling thread, opened as a group on first use.
+ * When they can't be (no PMU, perf_event_paranoid, seccomp...), reads fail
+ * and the run goes on without them */
+class perf_counters_t
+{
+public:
+    perf_counters_t();
+    ~perf_counters_t();
+
+    bool read(uint64_t * values);
+
+    static perf_counters_t & instance();
+
+private:
+    int open_counters();
+
+    static std::atomic<bool> _warned;
+
+    bool _opened;
+    int _fds[perf_counters_count];
+};
+
+extern bool perf_counting;
+
+/* Heap usage of a thread, counted by the global operator new and delete
+ * once heap_accounting is set. Programs that want it replace them, as
+ * pdb_viewer does for --stats */
+struct heap_usage_t
+{
+    uint64_t allocated_bytes;
+    int64_t in_use_bytes;
+    int64_t peak_in_use_bytes;
+};
+
+extern bool heap_accounting;
+extern thread_local heap_usage_t heap_usage;
+
+struct trace_event_t
+{
+    std::string name;
+    char const * category;
+    /* JSON object, empty for none */
+    std::string args;
+    uint32_t thread;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+/* Chrome trace of the extraction (--trace). Spans are kept by the thread
+ * recording them, and gathered when it exits or when the trace is written */
+class trace_t
+{
+public:
+    static void enable();
+    static bool enabled() { return _enabled; }
+    static uint64_t now();
+    static void record(trace_event_t & event);
+    static int write(char const * const file);
+
+private:
+    struct thread_events_t
+    {
+        thread_events_t();
+        ~thread_events_t();
+
+        uint32_t thread;
+        std::vector<trace_event_t> events;
+    };
+
+    static thread_events_t & thread_events();
+
+    static bool _enabled;
+    static std::chrono::steady_clock::time_point _epoch;
+    static std::atomic<uint32_t> _threads;
+    static std::mutex _lock;
+    static std::vector<trace_event_t> _events;
+};
+
+/* Records a span of the trace from begin() to its destruction, when tracing */
+class trace_span_t
+{
+public:
+    trace_span_t();
+    ~trace_span_t();
+
+    void begin(char const * category, std::string const & name, std::string const & args);
+
+private:
+    bool _active;
+    trace_event_t _event;
+};
+
+/* Accounts the time and the heap usage of the calling thread while it is in
+ * scope to a phase, if phases are given, and traces it. Without phases nor
+ * tracing, it costs two tests */
+class phase_scope_t
+{
+public:
+    phase_scope_t(phase_stats_t * phases, uint32_t phase, int32_t stream_index = -1);
+    ~phase_scope_t();
+
+    /* Phases of all the files processed so far */
+    static void add_totals(phase_stats_t const * const phases);
+    static void totals(phase_stats_t * phases);
+
+private:
+    static std::mutex _totals_lock;
+    static phase_stats_t _totals[phases_count];
+
+    phase_stats_t * _stats;
+    trace_span_t _span;
+    bool _counting;
+    uint64_t _perf_values[perf_counters_count];
+    std::chrono::steady_clock::time_point _start;
+    uint64_t _allocated_bytes;
+    int64_t _in_use_bytes;
+    int64_t _peak_in_use_bytes;
+};
+
+/* Pool of stream buffers, bucketed by size classes, four per power of two
+ * so that rounding wastes at most a quarter of a buffer. It is shared by
+ * all the files a thread processes, so that once a batch run is warmed up,
+ * stream buffers are recycled instead of hitting the heap. What all the
+ * threads keep cached is capped at once */
+struct buffer_pool_stats_t
+{
+    buffer_pool_stats_t();
+
+    void add(buffer_pool_stats_t const & stats);
+
+    uint64_t requests;
+    uint64_t heap_allocations;
+    uint64_t reuses;
+    uint64_t heap_frees;
+    uint64_t cached_bytes;
+};
+
+class buffer_pool_t
+{
+public:
+    buffer_pool_t();
+    ~buffer_pool_t();
+
+    void * acquire(uint32_t size);
+    void release(void * buffer, uint32_t size);
+
+    static buffer_pool_t & instance();
+    /* Threads add their counters to the totals before they exit */
+    static void retire();
+    static buffer_pool_stats_t totals();
+    /* Of the calling thread's pool */
+    buffer_pool_stats_t const & stats() const { return _stats; }
+
+private:
+    static std::mutex _retired_lock;
+    static buffer_pool_stats_t _retired;
+
+    static const uint32_t min_class_shift = 10;
+    static const uint32_t class_steps = 4;
+    static const uint32_t classes_count = (32 - min_class_shift) * class_steps + 1;
+    /* Over all the threads */
+    static const uint64_t max_cached_bytes = 256 * 1024 * 1024;
+    static std::atomic<uint64_t> _all_cached_bytes;
+
+    static uint32_t size_class(uint32_t size);
+    static uint64_t class_size(uint32_t size_class);
+
+    std::vector<void *> _free[classes_count];
+    uint64_t _cached_bytes;
+    buffer_pool_stats_t _stats;
+};
+
+/* Table of the names decoded from the streams. Names aren't copied: they
+ * are views into the stream buffers the table keeps alive, and duplicates
+ * are interned so that each distinct name is referenced once, by its id */
+class name_table_t
+{
+public:
+    ~name_table_t();
+
+    void adopt(void * buffer, uint32_t size);
+    uint32_t intern(char const * name, uint32_t length);
+
+    std::string_view name(uint32_t id) const { return _names[id]; }
+    uint32_t size() const { return _names.size(); }
+    /* Of the stream buffers kept alive, and of the table itself */
+    uint64_t buffers_size() const;
+    uint64_t memory_size() const;
+
+private:
+    std::vector<std::string_view> _names;
+    std::unordered_map<std::string_view, uint32_t> _ids;
+    std::vector<std::pair<void *, uint32_t> > _buffers;
+};
+
+/* Symbols loaded from the symbol stream, stored as a structure of arrays:
+ * scans filtering on a single field only walk that field's array */
+class symbol_store_t
+{
+public:
+    void push_back(uint32_t offset, uint32_t length, uint16_t kind, uint16_t segment, uint32_t name_id, uint32_t type_index);
+    void clear();
+    uint32_t size() const { return _offsets.size(); }
+
+    uint32_t offset(uint32_t symbol) const { return _offsets[symbol]; }
+    uint32_t length(uint32_t symbol) const { return _lengths[symbol]; }
+    uint16_t kind(uint32_t symbol) const { return _kinds[symbol]; }
+    uint16_t segment(uint32_t symbol) const { return _segments[symbol]; }
+    uint32_t name_id(uint32_t symbol) const { return _name_ids[symbol]; }
+    uint32_t type_index(uint32_t symbol) const { return _type_indexes[symbol]; }
+
+private:
+    std::vector<uint32_t> _offsets;
+    std::vector<uint32_t> _lengths;
+    std::vector<uint16_t> _kinds;
+    std::vector<uint16_t> _segments;
+    std::vector<uint32_t> _name_ids;
+    std::vector<uint32_t> _type_indexes;
+};
+
+/* Sorted array of 64-bit values, compressed by blocks of 128 values. Each
+ * block stores its first value as a skip entry, and the other values as
+ * offsets from it, bit packed on the smallest width that fits. Offsets are
+ * interleaved on four 32-bit lanes so that a block unpacks with SSE2 */
+class compressed_u64_array_t
+{
+public:
+    compressed_u64_array_t();
+
+    void push_back(uint64_t value);
+    void finish();
+    void clear();
+
+    uint64_t size() const { return _size; }
+    uint64_t memory_size() const;
+    bool find_last_not_greater(uint64_t value, uint64_t * position, uint64_t * found) const;
+
+private:
+    static const uint32_t block_size = 128;
+    static const uint32_t lanes = 4;
+    /* Blocks whose values span more than 32 bits are stored as is */
+    static const uint8_t raw_width = 64;
+
+    void pack_block();
+    void unpack_block(uint32_t block, uint64_t * values) const;
+
+    uint64_t _size;
+    uint64_t _pending[block_size];
+    uint32_t _pending_count;
+    std::vector<uint64_t> _bases;
+    std::vector<uint32_t> _starts;
+    std::vector<uint8_t> _widths;
+    std::vector<uint32_t> _words;
+};
+
+struct index_entry_t
+{
+    uint64_t key;
+    uint32_t symbol;
+};
+
+/* Symbols sorted by address (segment:offset), then by symbol. The memory
+ * budget covers the index itself, construction sorts in memory as long as
+ * the rest fits in it, otherwise it sorts runs that fit, spills them to
+ * temporary files and merges them afterwards */
+class address_index_t
+{
+public:
+    address_index_t();
+
+    int build(symbol_store_t const & symbols, uint64_t memory_budget, bool compress);
+    uint64_t memory_size() const;
+    bool find(uint16_t segment, uint32_t offset, uint32_t * symbol) const;
+    uint32_t spilled_runs() const { return _spilled_runs; }
+    /* Why build() failed */
+    std::string const & error() const { return _error; }
+
+private:
+    /* Keep the number of runs merged at once (and thus of open files) bounded */
+    static const uint32_t max_merged_runs = 64;
+
+    static uint64_t make_key(uint16_t segment, uint32_t offset) { return ((uint64_t)segment << 32) | offset; }
+
+    int spill_run(std::vector<index_entry_t> & run, std::vector<FILE *> & runs);
+    int merge_runs(std::vector<FILE *> const & runs, uint64_t memory_budget, FILE * output);
+    void append(index_entry_t const & entry);
+
+    bool _compressed;
+    std::vector<uint64_t> _keys;
+    compressed_u64_array_t _packed_keys;
+    std::vector<uint32_t> _symbols;
+    uint32_t _spilled_runs;
+    std::string _error;
+};
+
+/* Distribution of values, by power of two buckets: 0, 1, 2-3, 4-7... */
+class histogram_t
+{
+public:
+    histogram_t();
+
+    void add(uint32_t value);
+    void print(std::ostream & out) const;
+
+private:
+    static const uint32_t buckets_count = 33;
+
+    uint64_t _count;
+    uint64_t _sum;
+    uint32_t _min;
+    uint32_t _max;
+    uint64_t _buckets[buckets_count];
+};
+
+/* What records of a stream look like, for --histograms */
+struct records_histograms_t
+{
+    stream_kind_t kind;
+    uint64_t records;
+    std::map<uint16_t, uint64_t> kinds;
+    histogram_t lengths;
+    histogram_t name_lengths;
+};
+
+/* Names of a name table, sorted and front coded: names are grouped by
+ * buckets, each starting with a full name (the bucket head) followed by
+ * names only storing the length of the prefix they share with the previous
+ * name and their remaining suffix. It orders names for prefix lookups, on
+ * top of the table: names are still resolved by id through the table */
+class name_dictionary_t
+{
+public:
+    void build(name_table_t const & names);
+
+    uint32_t size() const { return _ids.size(); }
+    uint64_t memory_size() const;
+    uint32_t lower_bound(std::string_view name) const;
+    void enumerate_prefix(std::string_view prefix, std::vector<uint32_t> & ids) const;
+
+private:
+    static const uint32_t bucket_size = 16;
+
+    static void write_length(std::vector<char> & data, uint32_t length);
+    static uint32_t read_length(char const * & data);
+
+    std::string_view bucket_head(uint32_t bucket) const;
+    char const * next_name(char const * data, std::string & name) const;
+
+    std::vector<char> _data;
+    std::vector<uint32_t> _buckets;
+    /* Name ids, in name order */
+    std::vector<uint32_t> _ids;
+};
+
+/* I/O issued for a stream, or the root directory, with --stats */
+struct io_stats_t
+{
+    io_stats_t();
+
+    void add(io_stats_t const & stats);
+
+    /* pread() system calls, fread() calls with stdio */
+    uint64_t syscalls;
+    /* Reads not starting where the previous one ended, the first one included */
+    uint64_t seeks;
+    uint64_t bytes_read;
+    /* Bytes copied out of the mapping */
+    uint64_t bytes_copied;
+    /* Pages of the mapping read, and how many of them were in the page cache */
+    uint64_t pages;
+    uint64_t cached_pages;
+
+    uint64_t next_offset;
+};
+
+/* Positioned reads from the PDB file, through stdio, pread() or a mapping */
+class pdb_io_t
+{
+public:
+    pdb_io_t();
+    ~pdb_io_t();
+
+    int open(char const * const file, io_backend_t backend);
+    void close();
+    int size(uint64_t * size) const;
+    int read_at(void * buffer, uint64_t offset, uint32_t size, io_stats_t * stats = 0);
+
+    int fd() const { return _fd; }
+
+    /* I/O of all the files processed so far, for the root directory and per stream kind */
+    static void add_totals(io_stats_t const & directory, io_stats_t const * const kinds);
+    static void totals(io_stats_t * directory, io_stats_t * kinds);
+
+private:
+    static std::mutex _totals_lock;
+    static io_stats_t _directory_totals;
+    static io_stats_t _totals[stream_kinds_count];
+
+    void count_cached_pages(uint64_t offset, uint32_t size, io_stats_t * stats) const;
+
+    io_backend_t _backend;
+    FILE * _stream;
+    int _fd;
+    void * _mapping;
+    uint64_t _mapping_size;
+};
+
+/* A symbol, as returned by queries. Its name is a view into the streams of
+ * the file, valid as long as the pdb_file_t is */
+struct symbol_t
+{
+    uint16_t segment;
+    uint32_t offset;
+    uint16_t kind;
+    uint32_t type_index;
+    std::string_view name;
+};
+
+class pdb_file_t;
+
+/* A stream buffer walked by records views, released with the last view on
+ * it. Views are not to outlive their file */
+class records_buffer_t
+{
+public:
+    records_buffer_t(pdb_file_t * file, uint16_t stream_index, void * buffer, uint32_t size);
+    ~records_buffer_t();
+
+    char const * data() const { return (char const *)_buffer; }
+    uint32_t size() const { return _size; }
+    /* Reports how a walk stopped */
+    void failed(record_walk_t walk, uint32_t records) const;
+
+private:
+    pdb_file_t * _file;
+    uint16_t _stream_index;
+    void * _buffer;
+    uint32_t _size;
+};
+
+/* Records decoders for records_iterator_t: begin() locates the records,
+ * next() decodes one and moves past it, or sets next to null at the end */
+struct symbol_decoder_t
+{
+    typedef symbol_t value_type;
+
+    record_walk_t begin(records_buffer_t const * records, char const ** next, char const ** end)
+    {
+        *next = records->data() + sizeof(uint16_t);
+        *end = records->data() + records->size();
+        return records->size() < sizeof(uint16_t) ? record_walk_corrupted : record_walk_done;
+    }
+
+    record_walk_t next(char const ** next, char const * end, uint32_t, symbol_t * symbol)
+    {
+        symbol_record_t record;
+        record_walk_t walk;
+
+        walk = next_symbol_record(next, end, &record);
+        if (walk == record_walk_done && record.data == 0)
+        {
+            *next = 0;
+        }
+        else if (walk == record_walk_done)
+        {
+            symbol->segment = record.data->segment;
+            symbol->offset = record.data->offset;
+            symbol->kind = record.data->version;
+            symbol->type_index = record.data->type;
+            symbol->name = record.name;
+        }
+
+        return walk;
+    }
+};
+
+struct type_decoder_t
+{
+    typedef type_record_t value_type;
+
+    record_walk_t begin(records_buffer_t const * records, char const ** next, char const ** end)
+    {
+        tpi_header_t const * tpi_header = (tpi_header_t const *)records->data();
+
+        if (records->size() < sizeof(tpi_header_t))
+        {
+            return record_walk_corrupted;
+        }
+
+        _min_ti = tpi_header->min_ti;
+        return type_records_bounds(tpi_header, records->size(), next, end);
+    }
+
+    record_walk_t next(char const ** next, char const * end, uint32_t index, type_record_t * type)
+    {
+        record_walk_t walk;
+
+        walk = next_type_record(next, end, type);
+        if (walk == record_walk_done && type->data == 0)
+        {
+            *next = 0;
+        }
+
+        type->type_index = _min_ti + index;
+        return walk;
+    }
+
+    uint32_t _min_ti;
+};
+
+/* Newer DBI streams only. Streams with the header alone have no modules */
+struct module_decoder_t
+{
+    typedef module_t value_type;
+
+    record_walk_t begin(records_buffer_t const * records, char const ** next, char const ** end)
+    {
+        dbi_header_ex_t const * dbi_header = (dbi_header_ex_t const *)records->data();
+
+        _begin = records->data() + sizeof(dbi_header_ex_t);
+        *next = _begin;
+        *end = _begin;
+        if (records->size() < sizeof(dbi_header_ex_t))
+        {
+            return record_walk_done;
+        }
+
+        if (dbi_header->module_info_size > records->size() - sizeof(dbi_header_ex_t))
+        {
+            return record_walk_corrupted;
+        }
+
+        *end = _begin + dbi_header->module_info_size;
+        return record_walk_done;
+    }
+
+    record_walk_t next(char const ** next, char const * end, uint32_t index, module_t * module)
+    {
+        record_walk_t walk;
+
+        walk = next_module(next, _begin, end, module);
+        if (walk == record_walk_done && module->name.data() == 0)
+        {
+            *next = 0;
+        }
+
+        module->index = index;
+        return walk;
+    }
+
+    char const * _begin;
+};
+
+/* Section contribution substream, after the module info one */
+struct contribution_decoder_t
+{
+    typedef section_contribution_t value_type;
+
+    record_walk_t begin(records_buffer_t const * records, char const ** next, char const ** end)
+    {
+        dbi_header_ex_t const * dbi_header = (dbi_header_ex_t const *)records->data();
+        uint64_t available;
+
+        *next = records->data();
+        *end = records->data();
+        if (records->size() < sizeof(dbi_header_ex_t) || dbi_header->section_contribution_size == 0)
+        {
+            return record_walk_done;
+        }
+
+        available = records->size() - sizeof(dbi_header_ex_t);
+        if ((uint64_t)dbi_header->module_info_size + dbi_header->section_contribution_size > available ||
+            dbi_header->section_contribution_size < sizeof(uint32_t))
+        {
+            return record_walk_corrupted;
+        }
+
+        *next = records->data() + sizeof(dbi_header_ex_t) + dbi_header->module_info_size;
+        *end = *next + dbi_header->section_contribution_size;
+        switch (*(uint32_t const *)*next)
+        {
+            case section_contributions_version_60:
+                _stride = sizeof(section_contribution_t);
+                break;
+
+            case section_contributions_version_2:
+                _stride = sizeof(section_contribution_t) + sizeof(uint32_t);
+                break;
+
+            default:
+                return record_walk_unsupported;
+        }
+
+        *next += sizeof(uint32_t);
+        return record_walk_done;
+    }
+
+    record_walk_t next(char const ** next, char const * end, uint32_t, section_contribution_t * contribution)
+    {
+        if (*next == end)
+        {
+            *next = 0;
+            return record_walk_done;
+        }
+
+        if (*next + _stride > end)
+        {
+            return record_walk_corrupted;
+        }
+
+        memcpy(contribution, *next, sizeof(section_contribution_t));
+        *next += _stride;
+        return record_walk_done;
+    }
+
+    uint32_t _stride;
+};
+
+/* End of records views */
+struct records_end_t
+{
+};
+
+/* Input iterator over records, that decodes them as it goes */
+template <typename decoder_t>
+class records_iterator_t
+{
+public:
+    typedef typename decoder_t::value_type value_type;
+    typedef value_type const & reference;
+    typedef value_type const * pointer;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::input_iterator_tag iterator_category;
+
+    records_iterator_t() : _records(0), _next(0), _end(0), _records_count(0) {}
+
+    explicit records_iterator_t(records_buffer_t const * records) : _records(records), _next(0), _end(0), _records_count(0)
+    {
+        record_walk_t walk;
+
+        if (_records == 0)
+        {
+            return;
+        }
+
+        walk = _decoder.begin(_records, &_next, &_end);
+        if (walk != record_walk_done)
+        {
+            _records->failed(walk, 0);
+            _next = 0;
+            return;
+        }
+
+        advance();
+    }
+
+    reference operator*() const { return _value; }
+    pointer operator->() const { return &_value; }
+    records_iterator_t & operator++() { advance(); return *this; }
+    void operator++(int) { advance(); }
+
+    friend bool operator==(records_iterator_t const & iterator, records_end_t) { return iterator._next == 0; }
+    friend bool operator==(records_end_t, records_iterator_t const & iterator) { return iterator._next == 0; }
+    friend bool operator!=(records_iterator_t const & iterator, records_end_t) { return iterator._next != 0; }
+    friend bool operator!=(records_end_t, records_iterator_t const & iterator) { return iterator._next != 0; }
+
+private:
+    void advance()
+    {
+        record_walk_t walk;
+
+        walk = _decoder.next(&_next, _end, _records_count, &_value);
+        if (walk != record_walk_done)
+        {
+            _records->failed(walk, _records_count);
+            _next = 0;
+        }
+        else if (_next != 0)
+        {
+            ++_records_count;
+        }
+    }
+
+    records_buffer_t const * _records;
+    decoder_t _decoder;
+    char const * _next;
+    char const * _end;
+    uint32_t _records_count;
+    value_type _value;
+};
+
+/* Lazy range over the records of a stream. It holds the stream buffer, the
+ * names and data of records point into it */
+template <typename decoder_t>
+class records_view_t
+{
+public:
+    records_view_t() {}
+    explicit records_view_t(std::shared_ptr<records_buffer_t const> records) : _records(records) {}
+
+    records_iterator_t<decoder_t> begin() const { return records_iterator_t<decoder_t>(_records.get()); }
+    records_end_t end() const { return records_end_t(); }
+
+private:
+    std::shared_ptr<records_buffer_t const> _records;
+};
+
+typedef records_view_t<symbol_decoder_t> symbols_view_t;
+typedef records_view_t<type_decoder_t> types_view_t;
+typedef records_view_t<module_decoder_t> modules_view_t;
+typedef records_view_t<contribution_decoder_t> contributions_view_t;
+
+#if __cplusplus >= 202002L
+/* So that they compose with the standard views */
+template <typename decoder_t>
+inline constexpr bool std::ranges::enable_view<records_view_t<decoder_t> > = true;
+#endif
+
+/* Walks the symbols of a file, in stream order */
+class symbol_iterator_t
+{
+public:
+    symbol_iterator_t(pdb_file_t const * file, uint32_t symbol) : _file(file), _symbol(symbol) {}
+
+    symbol_t operator*() const;
+    symbol_iterator_t & operator++() { ++_symbol; return *this; }
+    bool operator==(symbol_iterator_t const & other) const { return _symbol == other._symbol; }
+    bool operator!=(symbol_iterator_t const & other) const { return _symbol != other._symbol; }
+
+private:
+    pdb_file_t const * _file;
+    uint32_t _symbol;
+};
+
+class pdb_file_t
+{
+public:
+    pdb_file_t(char const * const pdb_file, pdb_options_t const & options, std::ostream & out = std::cout, std::ostream & err = std::cerr);
+    ~pdb_file_t();
+
+    /* Dumps the file to the output stream */
+    void extract_pdb();
+
+    /* Queries, that return data and only print errors. The file is to be
+     * open()ed first, and its symbols loaded for the symbols queries */
+    int open();
+    uint16_t streams_count() const;
+    uint32_t stream_size(uint16_t stream_index) const;
+    stream_kind_t stream_kind(uint16_t stream_index) const;
+    int read_stream_data(uint16_t stream_index, std::vector<char> & data);
+    int load_symbols();
+    uint32_t symbols_count() const { return _symbols.size(); }
+    symbol_t symbol(uint32_t symbol) const;
+    symbol_iterator_t symbols_begin() const { return symbol_iterator_t(this, 0); }
+    symbol_iterator_t symbols_end() const { return symbol_iterator_t(this, _symbols.size()); }
+    bool lookup(uint16_t segment, uint32_t offset, symbol_t * symbol);
+    void find_prefix(std::string_view prefix, std::vector<symbol_t> & symbols);
+    /* Walk the symbol or type records with a visitor, see record_kind_t */
+    template <typename visitor_t, typename kinds_t = symbol_kinds_t>
+    int visit_symbols(visitor_t & visitor);
+    template <typename visitor_t, typename kinds_t = type_leaf_kinds_t>
+    int visit_types(visitor_t & visitor);
+    /* Lazy ranges over the records, decoded as they are iterated */
+    symbols_view_t symbols();
+    types_view_t types();
+    modules_view_t modules();
+    contributions_view_t section_contributions();
+    /* Global hashes of the type records (see hash_type_records()), and the
+     * TPI stream they were computed from */
+    int type_hashes(std::vector<char> & tpi_stream, std::vector<type_hash_t> & hashes);
+
+    /* Extraction stages, as extract_pdb() runs them, for harnesses timing
+     * them one by one: open_file(), validate_header(), open_root_stream(),
+     * then fetch_stream() and decode_stream() of each stream, the latter
+     * taking the buffer back, and print_symbols() */
+    int open_file();
+    int validate_header();
+    int open_root_stream();
+    uint32_t root_stream_size() const { return _header.root_stream.stream_size; }
+    void * fetch_stream(uint16_t stream_index);
+    void decode_stream(uint16_t stream_index, void * stream_buffer);
+    void print_symbols();
+    /* Loads the symbols of a symbol stream already in memory, which is to
+     * outlive them */
+    void decode_symbols(void const * stream_buffer, uint32_t size);
+
+private:
+    friend class records_buffer_t;
+
+    uint16_t const * stream_pages_list(uint16_t stream_index, uint32_t * pages) const;
+    int parse_pdb_header(pdb_stream_t const * const stream, pdb_stream_header_ex_t const * const pdb_header);
+    template <pdb_format_t format>
+    int parse_dbi(pdb_stream_t const * const stream, void const * const stream_buffer);
+    template <pdb_format_t format>
+    void print_dbi_version(void const * const stream_buffer);
+    template <pdb_format_t format>
+    void print_pdb_id(pdb_stream_t const * const stream, pdb_stream_header_ex_t const * const pdb_header);
+    int parse_headers();
+    int locate_symbols();
+    std::shared_ptr<records_buffer_t const> fetch_records(uint16_t stream_index);
+    int walk_failed(record_walk_t walk, stream_kind_t kind, uint32_t records);
+    int build_address_index();
+    void build_dictionary();
+    int read_pages(void * buffer, uint32_t size, uint32_t pages, uint16_t const * const pages_list, char const * const what, std::ostream & err, io_stats_t * stats);
+    void fetch_streams(uint16_t const * const pages_list, std::vector<void *> & buffers, std::vector<std::string> & errors);
+    void read_stream(pdb_stream_t const * const stream, uint16_t stream_index, uint32_t pages, uint16_t const * const pages_list);
+    void * fetch_stream(pdb_stream_t const * const stream, uint32_t pages, uint16_t const * const pages_list, io_stats_t * stats = 0);
+    void decode_stream(pdb_stream_t const * const stream, uint16_t stream_index, stream_kind_t kind, void * stream_buffer);
+
+    void read_stream_root_t(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+    void read_stream_pdb_header_t(pdb_stream_t const * const stream, uint16_t stream_index, pdb_stream_header_ex_t const * const pdb_header);
+    void read_stream_tpi(pdb_stream_t const * const stream, uint16_t stream_index, tpi_header_t const * const tpi_header);
+    void read_stream_dbi(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+    void read_stream_fpo(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+    void read_stream_gs(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+    void read_stream_ps(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+    void read_stream_sym(pdb_stream_t const * const stream, uint16_t stream_index, void const * const stream_buffer);
+
+    void lookup_symbols();
+    void list_prefixes();
+
+    phase_stats_t * phases() { return _options.stats ? _phases : 0; }
+    io_stats_t * directory_io() { return _options.stats ? &_directory_io : 0; }
+    io_stats_t * stream_io(uint16_t stream_index) { return _options.stats ? &_streams_io[stream_index] : 0; }
+    void print_io();
+    void histogram_symbols(uint16_t stream_index);
+    void histogram_types(uint16_t stream_index, tpi_header_t const * const tpi_header, uint32_t stream_size);
+    void print_histograms();
+
+    std::string _pdb_file;
+    pdb_options_t const & _options;
+    std::ostream & _out;
+    std::ostream & _err;
+    pdb_header_t _header;
+    pdb_io_t _io;
+    pdb_root_t * _root_stream;
+    uint32_t _pdb_version;
+    /* Decoders for the header layouts of the file, selected once its
+     * version is known */
+    struct decoders_t
+    {
+        int (pdb_file_t::*parse_dbi)(pdb_stream_t const * const stream, void const * const stream_buffer);
+        void (pdb_file_t::*print_dbi_version)(void const * const stream_buffer);
+        void (pdb_file_t::*print_pdb_id)(pdb_stream_t const * const stream, pdb_stream_header_ex_t const * const pdb_header);
+    };
+    static decoders_t const _format_decoders[pdb_formats_count];
+    pdb_format_t _format;
+    decoders_t const * _decoders;
+    uint16_t _gs_stream;
+    uint16_t _ps_stream;
+    uint16_t _sym_stream;
+    name_table_t _names;
+    symbol_store_t _symbols;
+    address_index_t _address_index;
+    bool _address_index_built;
+    name_dictionary_t _dictionary;
+    bool _dictionary_built;
+    phase_stats_t _phases[phases_count];
+    io_stats_t _directory_io;
+    std::vector<io_stats_t> _streams_io;
+    std::map<uint16_t, records_histograms_t> _histograms;
+};
+
+inline symbol_t symbol_iterator_t::operator*() const
+{
+    return _file->symbol(_symbol);
+}
+
+template <typename visitor_t, typename kinds_t>
+int pdb_file_t::visit_symbols(visitor_t & visitor)
+{
+    uint32_t size;
+    void * stream_buffer;
+    record_walk_t walk;
+
+    if (locate_symbols() == -1)
+    {
+        return -1;
+    }
+
+    stream_buffer = fetch_stream(_sym_stream);
+    if (stream_buffer == 0)
+    {
+        return -1;
+    }
+
+    size = _root_stream->streams[_sym_stream].stream_size;
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_decode + stream_kind_sym, _sym_stream);
+
+        walk = size < sizeof(uint16_t) ? record_walk_corrupted : walk_symbol_records(stream_buffer, size, visitor, kinds_t());
+    }
+
+    buffer_pool_t::instance().release(stream_buffer, size);
+    return walk_failed(walk, stream_kind_sym, 0);
+}
+
+template <typename visitor_t, typename kinds_t>
+int pdb_file_t::visit_types(visitor_t & visitor)
+{
+    uint32_t size;
+    uint32_t records = 0;
+    void * stream_buffer;
+    record_walk_t walk;
+
+    /* No types */
+    if (type_tpi < streams_count() && stream_size(type_tpi) == 0)
+    {
+        return 0;
+    }
+
+    stream_buffer = fetch_stream(type_tpi);
+    if (stream_buffer == 0)
+    {
+        return -1;
+    }
+
+    size = _root_stream->streams[type_tpi].stream_size;
+    {
+        phase_scope_t scope(phases(), (uint32_t)phase_decode + stream_kind_tpi, type_tpi);
+
+        walk = size < sizeof(tpi_header_t) ? record_walk_corrupted :
+               walk_type_records(static_cast<tpi_header_t const *>(stream_buffer), size, visitor, &records, kinds_t());
+    }
+
+    buffer_pool_t::instance().release(stream_buffer, size);
+    return walk_failed(walk, stream_kind_tpi, records);
+}
+
+/* Dumps the files, several at once with jobs */
+void extract_files(std::vector<char const *> const & files, pdb_options_t const & options, std::ostream & out = std::cout, std::ostream & err = std::cerr);
+/* Compares two files: symbols, types, modules, section contributions and
+ * stream sizes. 0 when they match, 1 when they differ, -1 on failure */
+int diff_files(char const * const old_file, char const * const new_file, pdb_options_t const & options, std::ostream & out = std::cout, std::ostream & err = std::cerr);
+/* Merges the types of the files in the store, several files hashed at once
+ * with jobs. Prints how many types each file has, and how many were new.
+ * -1 when a file failed, its types are then left out */
+int merge_types(std::vector<char const *> const & files, pdb_options_t const & options, type_store_t & store, std::ostream & out = std::cout, std::ostream & err = std::cerr);
+/* Size report of a file: its section contributions summed per section and
+ * module, and the sizes of its symbols summed per module, namespace and
+ * template, with the top largest of each. Symbols are summed by jobs threads */
+int report_sizes(char const * const pdb_file, pdb_options_t const & options, uint32_t top, std::ostream & out = std::cout, std::ostream & err = std::cerr);
+/* Statistics of all the files processed so far, with stats */
+void print_stats(std::ostream & err);
+
+#endif
@@ -0,0 +1,256 @@
+/*
+* pdb_view - A library for reading PDB files
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* C interface over pdb_file_t. No exception crosses it.
+*/
+
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <memory>
+
+#include "pdb_view.h"
+#include "pdb_view_c.h"
+
+struct pdb_view_file
+{
+    pdb_view_file(char const * const path, io_backend_t backend);
+
+    pdb_options_t options;
+    std::ostringstream out;
+    std::ostringstream err;
+    pdb_file_t file;
+    std::string errors;
+    std::vector<symbol_t> matches;
+};
+
+pdb_view_file::pdb_view_file(char const * const path, io_backend_t backend) : file(path, options, out, err)
+{
+    options.io_backend = backend;
+}
+
+static void to_c(symbol_t const & symbol, pdb_view_symbol_t * c_symbol)
+{
+    c_symbol->segment = symbol.segment;
+    c_symbol->kind = symbol.kind;
+    c_symbol->offset = symbol.offset;
+    c_symbol->type_index = symbol.type_index;
+    c_symbol->name.data = symbol.name.data();
+    c_symbol->name.length = symbol.name.size();
+}
+
+/* Messages end with a new line in the errors stream, not once copied */
+static void copy_error(std::string const & message, char * error, size_t error_size)
+{
+    size_t length = message.size();
+
+    if (error == 0 || error_size == 0)
+    {
+        return;
+    }
+
+    while (length > 0 && (message[length - 1] == '\n' || message[length - 1] == '\r'))
+    {
+        --length;
+    }
+
+    error_size = std::min(error_size - 1, length);
+    memcpy(error, message.data(), error_size);
+    error[error_size] = 0;
+}
+
+uint32_t pdb_view_abi_version(void)
+{
+    return PDB_VIEW_ABI_VERSION;
+}
+
+pdb_view_file_t * pdb_view_open(char const * path, char const * io_backend, char * error, size_t error_size)
+{
+    std::unique_ptr<pdb_view_file_t> file;
+    uint32_t backend = io_backend_stdio;
+
+    if (io_backend != 0)
+    {
+        for (backend = 0; backend < io_backends_count; ++backend)
+        {
+            if (strcmp(io_backend, io_backend_names[backend]) == 0)
+            {
+                break;
+            }
+        }
+
+        if (backend == io_backends_count)
+        {
+            copy_error(std::string("Unknown I/O backend: ") + io_backend, error, error_size);
+            return 0;
+        }
+    }
+
+    try
+    {
+        /* Owned until handed to the caller, whatever throws before */
+        file.reset(new pdb_view_file_t(path, (io_backend_t)backend));
+        if (file->file.open() == -1)
+        {
+            copy_error(file->err.str(), error, error_size);
+            return 0;
+        }
+    }
+    catch (std::exception const & exception)
+    {
+        copy_error(exception.what(), error, error_size);
+        return 0;
+    }
+
+    return file.release();
+}
+
+void pdb_view_close(pdb_view_file_t * file)
+{
+    delete file;
+}
+
+char const * pdb_view_errors(pdb_view_file_t * file)
+{
+    try
+    {
+        file->errors = file->err.str();
+    }
+    catch (std::exception const &)
+    {
+        return "";
+    }
+
+    return file->errors.c_str();
+}
+
+uint16_t pdb_view_streams_count(pdb_view_file_t * file)
+{
+    return file->file.streams_count();
+}
+
+uint32_t pdb_view_stream_size(pdb_view_file_t * file, uint16_t stream_index)
+{
+    return file->file.stream_size(stream_index);
+}
+
+int pdb_view_load_symbols(pdb_view_file_t * file)
+{
+    try
+    {
+        return file->file.load_symbols();
+    }
+    catch (std::exception const & exception)
+    {
+        file->err << exception.what() << std::endl;
+        return -1;
+    }
+}
+
+uint32_t pdb_view_symbols_count(pdb_view_file_t * file)
+{
+    return file->file.symbols_count();
+}
+
+uint32_t pdb_view_symbols_read(pdb_view_file_t * file, uint32_t first, pdb_view_symbol_t * symbols, uint32_t count)
+{
+    uint32_t symbol;
+
+    if (first >= file->file.symbols_count())
+    {
+        return 0;
+    }
+
+    count = std::min(count, file->file.symbols_count() - first);
+    for (symbol = 0; symbol < count; ++symbol)
+    {
+        to_c(file->file.symbol(first + symbol), &symbols[symbol]);
+    }
+
+    return count;
+}
+
+void pdb_view_symbols_iterate(pdb_view_file_t * file, pdb_view_symbol_iterator_t * iterator)
+{
+    iterator->file = file;
+    iterator->next = 0;
+}
+
+int pdb_view_symbols_next(pdb_view_symbol_iterator_t * iterator, pdb_view_symbol_t * symbol)
+{
+    if (iterator->next >= iterator->file->file.symbols_count())
+    {
+        return 0;
+    }
+
+    to_c(iterator->file->file.symbol(iterator->next), symbol);
+    ++iterator->next;
+    return 1;
+}
+
+int64_t pdb_view_lookup(pdb_view_file_t * file, pdb_view_address_t const * addresses, uint32_t count, pdb_view_symbol_t * symbols)
+{
+    uint32_t address;
+    uint32_t found = 0;
+
+    try
+    {
+        for (address = 0; address < count; ++address)
+        {
+            symbol_t symbol;
+
+            if (file->file.lookup(addresses[address].segment, addresses[address].offset, &symbol))
+            {
+                to_c(symbol, &symbols[address]);
+                ++found;
+            }
+            else
+            {
+                memset(&symbols[address], 0, sizeof(symbols[address]));
+            }
+        }
+    }
+    catch (std::exception const & exception)
+    {
+        file->err << exception.what() << std::endl;
+        return -1;
+    }
+
+    return found;
+}
+
+int64_t pdb_view_find_prefix(pdb_view_file_t * file, char const * prefix, size_t length, pdb_view_symbol_t * symbols, uint32_t capacity)
+{
+    uint32_t symbol;
+
+    try
+    {
+        file->file.find_prefix(std::string_view(prefix, length), file->matches);
+    }
+    catch (std::exception const & exception)
+    {
+        file->err << exception.what() << std::endl;
+        return -1;
+    }
+
+    for (symbol = 0; symbol < file->matches.size() && symbol < capacity; ++symbol)
+    {
+        to_c(file->matches[symbol], &symbols[symbol]);
+    }
+
+    return file->matches.size();
+}
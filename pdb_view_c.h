@@ -0,0 +1,100 @@
+/*
+* pdb_view - A library for reading PDB files
+* Copyright (C) 2026 agent <agent@local>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* C interface to the library, for callers through a FFI. Files are opaque
+* handles; symbols are returned by value in caller provided memory, with
+* their names as pointer and length into the file's stream buffers: they
+* aren't copied nor NUL terminated, and stay valid until the file is closed.
+*/
+
+#ifndef PDB_VIEW_C_H
+#define PDB_VIEW_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on incompatible changes of the functions or structures below */
+#define PDB_VIEW_ABI_VERSION 1
+
+typedef struct pdb_view_file pdb_view_file_t;
+
+typedef struct
+{
+    char const * data;
+    size_t length;
+} pdb_view_string_t;
+
+typedef struct
+{
+    uint16_t segment;
+    uint16_t kind;
+    uint32_t offset;
+    uint32_t type_index;
+    pdb_view_string_t name;
+} pdb_view_symbol_t;
+
+typedef struct
+{
+    uint16_t segment;
+    uint32_t offset;
+} pdb_view_address_t;
+
+/* Walks the symbols, see pdb_view_symbols_next() */
+typedef struct
+{
+    pdb_view_file_t * file;
+    uint32_t next;
+} pdb_view_symbol_iterator_t;
+
+uint32_t pdb_view_abi_version(void);
+
+/* Reads the header and root directory of the file, with I/O backend
+ * "stdio", "pread" or "mmap" (NULL for stdio). On failure, NULL is returned
+ * and the error message is written to error, when given */
+pdb_view_file_t * pdb_view_open(char const * path, char const * io_backend, char * error, size_t error_size);
+void pdb_view_close(pdb_view_file_t * file);
+/* Errors printed since the file was opened, NUL terminated */
+char const * pdb_view_errors(pdb_view_file_t * file);
+
+uint16_t pdb_view_streams_count(pdb_view_file_t * file);
+uint32_t pdb_view_stream_size(pdb_view_file_t * file, uint16_t stream_index);
+
+/* Decodes the symbol stream. 0 on success, -1 on failure */
+int pdb_view_load_symbols(pdb_view_file_t * file);
+uint32_t pdb_view_symbols_count(pdb_view_file_t * file);
+/* Copies up to count symbols from first on, returns how many were */
+uint32_t pdb_view_symbols_read(pdb_view_file_t * file, uint32_t first, pdb_view_symbol_t * symbols, uint32_t count);
+void pdb_view_symbols_iterate(pdb_view_file_t * file, pdb_view_symbol_iterator_t * iterator);
+/* 1 and the next symbol, 0 when done */
+int pdb_view_symbols_next(pdb_view_symbol_iterator_t * iterator, pdb_view_symbol_t * symbol);
+
+/* Symbols containing each address. Symbols not found have a NULL name.
+ * Returns how many were found, or -1 on failure */
+int64_t pdb_view_lookup(pdb_view_file_t * file, pdb_view_address_t const * addresses, uint32_t count, pdb_view_symbol_t * symbols);
+/* Symbols whose name starts with prefix, in name order. Up to capacity are
+ * written, how many matched is returned, or -1 on failure */
+int64_t pdb_view_find_prefix(pdb_view_file_t * file, char const * prefix, size_t length, pdb_view_symbol_t * symbols, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif